@@ -8,51 +8,156 @@
  * Date: March 9, 2020. Version 1.0
  *
  * The main driver for aubatch, sets up all the necessary variables
- * for the program to work properly. Creates two threads, executor and disaptcher
+ * for the program to work properly. Creates the executor thread, the supervisor
+ * and a pool of dispatcher workers, one per online cpu unless -w <workers> is
+ * given. At most -j <jobs> jobs run at once, by default one per online cpu.
+ * With -l <job_log> a record of every finished job is appended to job_log and
+ * with -a <summary_log> the overall metrics are appended every -i <seconds>.
+ * With -m <port|socket> live counters are served for Prometheus to scrape
  *
  * Compilation Instruction: 
- * gcc -o aubatch.out aubatch.c commandline.c modules.c -lpthread -Wall
+ * gcc -o aubatch.out aubatch.c commandline.c modules.c queue.c launcher.c metrics.c simulate.c workload.c trace.c channel.c server.c journal.c export.c telemetry.c placement.c dependency.c -lpthread -lm -Wall
  *
  */
 
 #include "commandline.h"
 #include "modules.h"
+#include "metrics.h"
+#include "server.h"
+#include "journal.h"
+#include "export.h"
+#include "telemetry.h"
+
+#include <stdint.h>
+
+/*
+ * Prints the command line options and exits
+ */
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-w <workers>] [-j <jobs>] [-l <job_log>] [-a <summary_log>] [-i <seconds>] [-m <port|socket>] [-s <socket>] [-J <journal>]\n", name);
+    fprintf(stderr, "\t-w <workers>: number of dispatcher workers, default one per online cpu\n");
+    fprintf(stderr, "\t-j <jobs>: most jobs run at once, default one per online cpu\n");
+    fprintf(stderr, "\t-l <job_log>: append a record of every finished job to job_log, json lines if it ends in %s, csv otherwise\n", JSONL_SUFFIX);
+    fprintf(stderr, "\t-a <summary_log>: append the overall metrics to summary_log while jobs run, json lines or csv like -l\n");
+    fprintf(stderr, "\t-i <seconds>: seconds between summaries, default %d\n", DEFAULT_SUMMARY_SECONDS);
+    fprintf(stderr, "\t-m <port|socket>: serve live counters in the Prometheus text format on a loopback port or a unix socket\n");
+    fprintf(stderr, "\t-s <socket>: run as a daemon taking commands from aubatch-client on socket instead of the prompt\n");
+    fprintf(stderr, "\t-J <journal>: journal jobs to journal and queue the unfinished ones again on the next start\n");
+    exit(1);
+}
 
 int main(int argc, char **argv)
 {
-    printf("Welcome to Jordan Sosnowski's batch job scheduler Version 1.0.\nType 'help' to find more about AUbatch commands.\n");
-    pthread_t executor_thread, dispatcher_thread; /* Two concurrent threads */
+    pthread_t executor_thread;   /* command line thread, or the socket front end with -s */
+    pthread_t supervisor_thread; /* reaps running jobs */
+    pthread_t stage_thread;      /* moves submissions onto the run queues */
+    pthread_t *dispatcher_threads; /* one thread per dispatcher worker */
 
-    int iret1, iret2;
+    int iret1, iret2 = 0;
 
     policy = FCFS; // default policy for scheduler
+    num_workers = get_default_workers();
+    num_slots = get_default_workers();
 
-    /* Initialize count, three buffer pointers */
+    const char *socket_path = NULL;
+    const char *journal_path = NULL;
+    const char *summary_path = NULL;
+    const char *telemetry_endpoint = NULL;
+    int summary_seconds = DEFAULT_SUMMARY_SECONDS;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:j:l:a:i:m:s:J:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'w':
+            num_workers = atoi(optarg);
+            break;
+        case 'j':
+            num_slots = atoi(optarg);
+            break;
+        case 'l':
+            if (open_job_log(optarg))
+                exit(1);
+            break;
+        case 'a':
+            summary_path = optarg;
+            break;
+        case 'i':
+            summary_seconds = atoi(optarg);
+            break;
+        case 'm':
+            telemetry_endpoint = optarg;
+            break;
+        case 's':
+            socket_path = optarg;
+            break;
+        case 'J':
+            journal_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if ((int)num_workers <= 0 || (int)num_slots <= 0 || summary_seconds <= 0)
+        usage(argv[0]);
+    if (summary_path && open_summary_log(summary_path, summary_seconds))
+        exit(1);
+    if (telemetry_endpoint && telemetry_open(telemetry_endpoint))
+        exit(1);
+
+    if (socket_path)
+    {
+        // a daemon's output usually goes to a log, keep it current
+        setvbuf(stdout, NULL, _IOLBF, 0);
+        printf("AUbatch Version 1.0 listening on %s.\n", socket_path);
+    }
+    else
+        printf("Welcome to Jordan Sosnowski's batch job scheduler Version 1.0.\nType 'help' to find more about AUbatch commands.\n");
+
+    /* Initialize count and the worker run queues */
     count = 0;
-    buf_head = 0;
-    buf_tail = 0;
-    finished_head = 0;
-    batch = 0;
+    next_id = 0;
+    init_workers();
+    init_supervisor();
+    dispatcher_threads = malloc(num_workers * sizeof(pthread_t));
+
+    /* Initialize the finished metrics lock before either thread can use it */
+    pthread_mutex_init(&finished_lock, NULL);
 
-    /* Create two independent threads: executor and dispatcher */
+    /* Queue the jobs a previous run left unfinished before anything can start */
+    if (journal_path && journal_open(journal_path))
+        exit(1);
 
-    iret1 = pthread_create(&executor_thread, NULL, commandline, (void *)NULL);
-    iret2 = pthread_create(&dispatcher_thread, NULL, dispatcher, (void *)NULL);
+    /* Create the executor thread and the dispatcher workers */
 
-    /* Initialize the lock the two condition variables */
-    pthread_mutex_init(&cmd_queue_lock, NULL);
-    pthread_cond_init(&cmd_buf_not_full, NULL);
-    pthread_cond_init(&cmd_buf_not_empty, NULL);
+    if (socket_path && init_server(socket_path))
+        exit(1);
+    iret1 = pthread_create(&executor_thread, NULL, socket_path ? server : commandline, (void *)NULL);
+    if (!iret1)
+        iret1 = pthread_create(&supervisor_thread, NULL, supervisor, (void *)NULL);
+    if (!iret1)
+        iret1 = pthread_create(&stage_thread, NULL, scheduler_stage, (void *)NULL);
+    int i, started;
+    for (started = 0; started < num_workers; started++)
+    {
+        iret2 = pthread_create(&dispatcher_threads[started], NULL, dispatcher, (void *)(uintptr_t)started);
+        if (iret2)
+            break;
+    }
 
     /* Wait till threads are complete before main continues. Unless we  */
     /* wait we run the risk of executing an exit which will terminate   */
     /* the process and all threads before the threads have completed.   */
     pthread_join(executor_thread, NULL);
-    pthread_join(dispatcher_thread, NULL);
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(dispatcher_threads[i], NULL);
+    }
 
     if (iret1)
         printf("executor_thread returns: %d\n", iret1);
     if (iret2)
-        printf("dispatcher_thread returns: %d\n", iret1);
+        printf("dispatcher_thread returns: %d\n", iret2);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+ * COMP7500/7506
+ * Project 3: submission channel
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * A bounded multi-producer single-consumer ring of pointers. Producers claim
+ * positions with a compare and swap on head and never wait on each other or
+ * on the consumer, a full channel is reported instead of waited on
+ *
+ * Every cell carries a sequence number. A cell at index i is free for position
+ * p when its sequence equals p, and holds the value for position p once its
+ * sequence is p + 1. The consumer frees a cell for the next lap by setting its
+ * sequence to p + capacity. Cells are freed strictly in order, so if the last
+ * cell of a run of positions is free the whole run is
+ *
+ */
+
+#include "channel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Sets up an empty channel with room for at least capacity values
+ */
+void channel_init(channel_t *channel, size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    channel->cells = malloc(size * sizeof(channel_cell_t));
+    if (channel->cells == NULL)
+    {
+        perror("Unable to malloc channel");
+        exit(1);
+    }
+
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        atomic_init(&channel->cells[i].sequence, i);
+    }
+    channel->mask = size - 1;
+    atomic_init(&channel->head, 0);
+    channel->tail = 0;
+}
+
+/*
+ * Claims n consecutive positions, returns 0 and the first one in position or
+ * -1 if the channel does not have n free cells
+ */
+static int claim(channel_t *channel, size_t n, size_t *position)
+{
+    size_t head = atomic_load_explicit(&channel->head, memory_order_relaxed);
+    while (1)
+    {
+        size_t last = head + n - 1;
+        size_t sequence = atomic_load_explicit(&channel->cells[last & channel->mask].sequence, memory_order_acquire);
+        if (sequence != last)
+        {
+            // the last cell is still held from the previous lap, unless another producer moved head on
+            size_t now = atomic_load_explicit(&channel->head, memory_order_relaxed);
+            if (now == head)
+                return -1;
+            head = now;
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&channel->head, &head, head + n, memory_order_relaxed, memory_order_relaxed))
+        {
+            *position = head;
+            return 0;
+        }
+    }
+}
+
+/*
+ * Pushes one value, returns -1 without waiting if the channel is full
+ */
+int channel_push(channel_t *channel, void *value)
+{
+    size_t position;
+    if (claim(channel, 1, &position))
+        return -1;
+
+    channel_cell_t *cell = &channel->cells[position & channel->mask];
+    cell->value = value;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    return 0;
+}
+
+/*
+ * Pushes n values at consecutive positions. They are published last to first
+ * so the consumer, which stops at the first unpublished cell, sees all of
+ * them at once or none of them
+ */
+int channel_push_many(channel_t *channel, void **values, size_t n)
+{
+    size_t position;
+    if (!n)
+        return 0;
+    if (n > channel->mask + 1 || claim(channel, n, &position))
+        return -1;
+
+    size_t i = n;
+    while (i-- > 0)
+    {
+        channel_cell_t *cell = &channel->cells[(position + i) & channel->mask];
+        cell->value = values[i];
+        atomic_store_explicit(&cell->sequence, position + i + 1, memory_order_release);
+    }
+    return 0;
+}
+
+/*
+ * Takes the oldest value off the channel, NULL if it is empty. Only one
+ * thread may pop
+ */
+void *channel_pop(channel_t *channel)
+{
+    channel_cell_t *cell = &channel->cells[channel->tail & channel->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (sequence != channel->tail + 1)
+        return NULL;
+
+    void *value = cell->value;
+    atomic_store_explicit(&cell->sequence, channel->tail + channel->mask + 1, memory_order_release);
+    channel->tail++;
+    return value;
+}
@@ -0,0 +1,43 @@
+/*
+ * COMP7500/7506
+ * Project 3: submission channel header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the bounded lock-free submission channel, used by the
+ * scheduling module
+ *
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define CACHE_LINE 64 /* keeps the producer and consumer positions off each other's cache line */
+
+typedef struct
+{
+    atomic_size_t sequence; /* position this cell is ready for, see channel.c */
+    void *value;
+
+} channel_cell_t;
+
+typedef struct
+{
+    channel_cell_t *cells;
+    size_t mask;                              /* capacity - 1, the capacity is a power of two */
+    _Alignas(CACHE_LINE) atomic_size_t head;  /* next position producers claim */
+    _Alignas(CACHE_LINE) size_t tail;         /* next position the single consumer reads */
+
+} channel_t;
+
+void channel_init(channel_t *channel, size_t capacity);           /* capacity is rounded up to a power of two */
+int channel_push(channel_t *channel, void *value);                /* 0 on success, -1 if the channel is full, never blocks */
+int channel_push_many(channel_t *channel, void **values, size_t n); /* pushes n values that become visible together, -1 if they do not fit */
+void *channel_pop(channel_t *channel);                            /* consumer only, NULL if the channel is empty */
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * COMP7500/7506
+ * Project 3: aubatch-client
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Sends commands to an aubatch started with -s and prints the answers, see
+ * server.h for the protocol
+ *
+ * ./aubatch-client run ./microbatch.out 2 1 sends one command, with no
+ * command the commands are read from stdin one per line. Commands are sent
+ * without waiting for the answers to the ones before them, so a file of runs
+ * goes through at the rate the socket allows. Payload lines are printed
+ * without their prefix, status lines as they are. The exit status is 1 if
+ * any command was answered with err
+ *
+ */
+
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define CLIENT_BUFFER 65536 /* bytes moved between stdin, the socket and stdout at a time */
+
+/*
+ * Prints the command line options and exits
+ */
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-s <socket>] [<command> [<args>]]\n", name);
+    fprintf(stderr, "\t-s <socket>: socket aubatch is listening on, default %s\n", DEFAULT_SOCKET);
+    fprintf(stderr, "\twithout a command the commands are read from stdin, one per line\n");
+    exit(1);
+}
+
+/*
+ * Connects to aubatch, exits if nothing is listening
+ */
+static int connect_server(const char *path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        exit(1);
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        fprintf(stderr, "Unable to connect to aubatch on %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+    return fd;
+}
+
+/*
+ * Prints one answer line, returns 1 if it reports an error
+ */
+static int print_answer(char *line)
+{
+    size_t prefix = strlen(PAYLOAD_PREFIX);
+    if (!strncmp(line, PAYLOAD_PREFIX, prefix))
+    {
+        puts(line + prefix);
+        return 0;
+    }
+    puts(line);
+    return !strncmp(line, "err", 3);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = DEFAULT_SOCKET;
+    int opt;
+    while ((opt = getopt(argc, argv, "+s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    int fd = connect_server(path);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // commands waiting to be sent
+    char *out = malloc(CLIENT_BUFFER);
+    size_t out_len = 0;
+    size_t out_sent = 0;
+    // answers waiting for the rest of their line
+    char *in = malloc(CLIENT_BUFFER + 1);
+    size_t in_len = 0;
+    if (out == NULL || in == NULL)
+    {
+        perror("Unable to malloc buffers");
+        exit(1);
+    }
+
+    // a command given as arguments is sent on its own
+    int stdin_done = optind < argc;
+    int i;
+    for (i = optind; i < argc; i++)
+    {
+        size_t length = strlen(argv[i]);
+        if (out_len + length + 1 >= CLIENT_BUFFER)
+        {
+            fprintf(stderr, "Command is too long\n");
+            exit(1);
+        }
+        memcpy(out + out_len, argv[i], length);
+        out_len += length;
+        out[out_len++] = i + 1 < argc ? ' ' : '\n';
+    }
+
+    int shut = 0;
+    int failed = 0;
+    while (1)
+    {
+        // once every command is sent the server sees end of file, answers the rest and closes
+        if (stdin_done && out_sent == out_len && !shut)
+        {
+            shutdown(fd, SHUT_WR);
+            shut = 1;
+        }
+
+        struct pollfd fds[2] = {
+            {.fd = fd, .events = POLLIN | (out_sent < out_len ? POLLOUT : 0)},
+            {.fd = stdin_done || out_len ? -1 : STDIN_FILENO, .events = POLLIN},
+        };
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("poll failed");
+            exit(1);
+        }
+
+        if (fds[1].revents)
+        {
+            ssize_t got = read(STDIN_FILENO, out, CLIENT_BUFFER);
+            if (got <= 0)
+                stdin_done = 1;
+            else
+                out_len = got;
+        }
+
+        if (fds[0].revents & POLLOUT)
+        {
+            ssize_t sent = send(fd, out + out_sent, out_len - out_sent, MSG_NOSIGNAL);
+            if (sent < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                perror("Unable to send commands");
+                exit(1);
+            }
+            if (sent > 0)
+                out_sent += sent;
+            if (out_sent == out_len)
+                out_len = out_sent = 0;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            ssize_t got = read(fd, in + in_len, CLIENT_BUFFER - in_len);
+            if (got < 0 && (errno == EAGAIN || errno == EINTR))
+                continue;
+            if (got <= 0)
+                break;
+            in_len += got;
+
+            char *line = in;
+            char *newline;
+            while ((newline = memchr(line, '\n', in + in_len - line)))
+            {
+                *newline = '\0';
+                failed |= print_answer(line);
+                line = newline + 1;
+            }
+            in_len = in + in_len - line;
+            memmove(in, line, in_len);
+            if (in_len == CLIENT_BUFFER)
+            {
+                // no answer is this long, print it rather than stall
+                in[in_len] = '\0';
+                failed |= print_answer(in);
+                in_len = 0;
+            }
+        }
+    }
+
+    if (in_len)
+    {
+        in[in_len] = '\0';
+        failed |= print_answer(in);
+    }
+    close(fd);
+    return failed;
+}
@@ -12,24 +12,41 @@
  * to scheduler and dispatcher
  *
  * Compilation Instruction: 
- * gcc -o aubatch.out aubatch.c commandline.c modules.c -lpthread -Wall
+ * gcc -o aubatch.out aubatch.c commandline.c modules.c queue.c launcher.c metrics.c simulate.c workload.c trace.c channel.c server.c journal.c export.c telemetry.c placement.c dependency.c -lpthread -lm -Wall
  *
  */
 
 #include "commandline.h"
 #include "modules.h"
+#include "metrics.h"
+#include "simulate.h"
+#include "trace.h"
+#include "placement.h"
+#include "dependency.h"
 
+#include <errno.h>
 #include <sys/stat.h>
 
 // char array of help definitions
 static const char *helpmenu[] = {
     "run <job> <time> <priority>: submit a job named <job>, execution time is <time>, priority is <pr>",
+    "run --cpus <n> [--numa <any|local|interleave|node>] <job> <time> <priority>: pin the job to <n> cores, on one numa node with local, spread with interleave",
+    "run --after|--afterany <job_id>,... <job> <time> <priority>: hold the job until the listed jobs succeed, or with --afterany finish, it is cancelled if one fails",
     "list: display the job status",
     "help: print help menu",
     "fcfs: change the scheduling policy to FCFS",
     "sjf: changes the scheduling policy to SJF",
     "priority: changes the scheduling policy to priority",
-    "test <benchmark> <policy> <num_of_jobs> <arrival_time> <priority_levels> <min_CPU_time> <max_CPU_time>",
+    "rr <quantum_ms>: changes the scheduling policy to round robin with a <quantum_ms> time slice",
+    "srtf: changes the scheduling policy to preemptive shortest remaining time first",
+    "mlfq [<quantum_ms>,<quantum_ms>,...] [<boost_ms>]: changes the scheduling policy to a multi-level feedback queue, one quantum per level",
+    "backfill: changes the scheduling policy to fcfs with EASY backfilling of jobs onto free cores",
+    "test <benchmark> <fcfs|sjf|priority|rr|srtf|mlfq|backfill> <num_of_jobs> <arrival_time> <priority_levels> <min_CPU_time> <max_CPU_time> [options]",
+    "simulate <benchmark> <fcfs|sjf|priority> <num_of_jobs> <arrival_time> <priority_levels> <min_CPU_time> <max_CPU_time> [options]: runs test in virtual time",
+    "    test and simulate options: seed=<n> arrival=fixed|exp burst=uniform|pareto[:<alpha>]|lognormal[:<sigma>] priority=uniform|zipf[:<s>], and cpus=<max> for test",
+    "replay <file> [scale]: submits the jobs of a .swf or .csv trace at their recorded times, <scale> times faster",
+    "submit -f <file>: submits one job per line of <file>, each line is <job> <time> <priority>. With -f - the lines are read from stdin up to a line with a single .",
+    "wait [<job_id>]: blocks until every job has finished, or until job <job_id> has finished and prints its exit status",
     "quit: exit AUbatch | -i quits after current job finishes | -d quits after all jobs finish",
     NULL};
 
@@ -48,14 +65,29 @@ static const cmd cmdtable[] = {
     {"run", cmd_run},
     {"q", cmd_quit},
     {"quit", cmd_quit},
-    {"fcfs", cmd_fcfs},
-    {"sjf", cmd_sjf},
-    {"priority", cmd_priority},
     {"list", cmd_list},
     {"ls", cmd_list},
     {"test", cmd_test},
+    {"simulate", cmd_simulate},
+    {"replay", cmd_replay},
+    {"submit", cmd_submit},
+    {"wait", cmd_wait},
     {NULL, NULL}};
 
+static int configure_rr(int nargs, char **args);
+static int configure_mlfq(int nargs, char **args);
+
+// every scheduling policy by name, the policy commands, test and the socket front end all use it
+const policy_cmd policy_table[] = {
+    {"fcfs", FCFS, NULL},
+    {"sjf", SJF, NULL},
+    {"priority", PRIORITY, NULL},
+    {"rr", RR, configure_rr},
+    {"srtf", SRTF, NULL},
+    {"mlfq", MLFQ, configure_mlfq},
+    {"backfill", BACKFILL, NULL},
+    {NULL, 0, NULL}};
+
 /*
  * Command line main loop.
  */
@@ -120,6 +152,9 @@ int cmd_dispatch(char *cmd)
         }
     }
 
+    if (find_policy(args[0]))
+        return cmd_policy(nargs, args);
+
     printf("%s: Command not found\n", args[0]);
     return EINVAL;
 }
@@ -129,9 +164,22 @@ int cmd_dispatch(char *cmd)
  */
 int cmd_run(int nargs, char **args)
 {
+    placement_t placement;
+    dependency_t *after;
+    int num_after;
+    const char *error = parse_dependencies(&nargs, args, &after, &num_after);
+    if (!error)
+        error = parse_placement(&nargs, args, &placement);
+    if (error)
+    {
+        printf("Error: %s\n", error);
+        free(after);
+        return EINVAL;
+    }
     if (nargs != 4)
     {
-        printf("Usage: run <job> <time> <priority>\n");
+        printf("Usage: run [--after|--afterany <job_id>,...] [--cpus <n>] [--numa <any|local|interleave|node>] <job> <time> <priority>\n");
+        free(after);
         return EINVAL;
     }
     // ensure file exists first
@@ -139,11 +187,11 @@ int cmd_run(int nargs, char **args)
     if (f == NULL)
     {
         printf("Error file does not exist. Please use relative or full path\n");
-        fclose(f);
+        free(after);
         return EINVAL;
     }
     fclose(f);
-    scheduler(nargs, args);
+    scheduler(nargs, args, &placement, after, num_after);
     return 0; /* if succeed */
 }
 
@@ -157,26 +205,18 @@ int cmd_quit(int nargs, char **args)
         if (!strcmp(args[1], "-i")) // wait for current job to finish running
         {
 
-            int cur_count = count;
             printf("Waiting for current job to finish ... \n");
-            if (count)
-            {
-                while (cur_count == count)
-                {
-                }
-            }
+            wait_for_next_completion();
         }
         else if (!strcmp(args[1], "-d")) // wait for all jobs to finish
         {
             printf("Waiting for all jobs to finish...\n");
-            while (count)
-            {
-            }
+            wait_for_idle();
         }
     }
     printf("Quiting AUBatch... \n");
 
-    report_metrics();
+    report_metrics(stdout, get_policy_string());
 
     exit(0);
 }
@@ -205,32 +245,104 @@ int cmd_helpmenu(int n, char **a)
 }
 
 /*
- * change scheduler to priority based
+ * Returns the policy called name, NULL if there is none
  */
-int cmd_priority()
+const policy_cmd *find_policy(const char *name)
 {
-    policy = PRIORITY;
+    const policy_cmd *entry;
+    for (entry = policy_table; entry->name; entry++)
+    {
+        if (!strcmp(name, entry->name))
+            return entry;
+    }
+    return NULL;
+}
+
+/*
+ * Writes every policy name into buffer, separated by |
+ */
+void policy_names(char *buffer, size_t size)
+{
+    const policy_cmd *entry;
+    size_t length = 0;
+    buffer[0] = '\0';
+    for (entry = policy_table; entry->name && length < size; entry++)
+    {
+        length += snprintf(buffer + length, size - length, "%s%s", entry == policy_table ? "" : "|", entry->name);
+    }
+}
+
+/*
+ * change scheduler to the policy named by args[0]
+ *
+ * rr and mlfq take their settings as arguments first, the other policies
+ * take none
+ */
+int cmd_policy(int nargs, char **args)
+{
+    const policy_cmd *entry = find_policy(args[0]);
+    if (entry == NULL || (entry->configure && entry->configure(nargs, args)))
+        return EINVAL;
+
+    policy = entry->policy;
     change_scheduler();
     return 0;
 }
 
 /*
- * change scheduler to shorted job first
+ * round robin with the given time slice
  */
-int cmd_sjf()
+static int configure_rr(int nargs, char **args)
 {
-    policy = SJF;
-    change_scheduler();
+    if (nargs != 2 || atoi(args[1]) <= 0)
+    {
+        printf("Usage: rr <quantum_ms>\n");
+        return EINVAL;
+    }
+    quantum_ms = atoi(args[1]);
     return 0;
 }
 
 /*
- * change scheduler to first come first served
+ * a multi-level feedback queue
+ *
+ * the optional first argument is a comma separated list of time slices, one
+ * per level from the top down, the optional second is the boost period
  */
-int cmd_fcfs()
+static int configure_mlfq(int nargs, char **args)
 {
-    policy = FCFS;
-    change_scheduler();
+    if (nargs > 3)
+    {
+        printf("Usage: mlfq [<quantum_ms>,<quantum_ms>,...] [<boost_ms>]\n");
+        return EINVAL;
+    }
+
+    if (nargs >= 2)
+    {
+        u_int quanta[MLFQ_MAX_LEVELS];
+        u_int levels = 0;
+        char *context;
+        char *quantum;
+        for (quantum = strtok_r(args[1], ",", &context); quantum; quantum = strtok_r(NULL, ",", &context))
+        {
+            if (levels == MLFQ_MAX_LEVELS || atoi(quantum) <= 0)
+            {
+                printf("Error: mlfq takes 1 to %d time slices greater than 0\n", MLFQ_MAX_LEVELS);
+                return EINVAL;
+            }
+            quanta[levels++] = atoi(quantum);
+        }
+        if (!levels || (nargs == 3 && atoi(args[2]) <= 0))
+        {
+            printf("Usage: mlfq [<quantum_ms>,<quantum_ms>,...] [<boost_ms>]\n");
+            return EINVAL;
+        }
+
+        memcpy(mlfq_quanta, quanta, sizeof(quanta));
+        mlfq_levels = levels;
+        if (nargs == 3)
+            boost_ms = atoi(args[2]);
+    }
     return 0;
 }
 
@@ -240,9 +352,23 @@ int cmd_fcfs()
 void change_scheduler()
 {
     const char *str_policy = get_policy_string();
-    printf("Scheduling policy is switched to %s. All the %d waiting jobs have been rescheduled.\n", str_policy, buf_head - buf_tail);
-    if (count)
-        sort_buffer(process_buffer);
+    u_int waiting = 0;
+
+    // jobs parked behind the old reservation are ordered by the new policy with the rest
+    requeue_processes(reset_reservation());
+    lock_all_workers();
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        rq_reorder(&workers[i].queue, get_policy_compare(), get_policy_levels());
+        waiting += workers[i].queue.size;
+    }
+    unlock_all_workers();
+
+    printf("Scheduling policy is switched to %s. All the %d waiting jobs have been rescheduled.\n", str_policy, waiting);
+
+    // the supervisor only keeps time slices under round robin
+    wake_supervisor();
 }
 
 /*
@@ -250,53 +376,256 @@ void change_scheduler()
  */
 int cmd_list()
 {
-    if (finished_head || count)
+    return list_jobs(stdout);
+}
+
+/*
+ * Writes the finished, running and waiting processes to out, shared by list
+ * and the socket front end
+ */
+int list_jobs(FILE *out)
+{
+    if (recent_head || count)
     {
-        printf("Name               CPU_Time Pri Arrival_time             Progress\n");
-        int i;
-        for (i = 0; i < finished_head; i++)
+        // under mlfq the feedback level and level transitions of each job are shown too
+        int mlfq = policy == MLFQ;
+        // cpu used and peak memory are only known once a job has been reaped
+        if (mlfq)
+            fprintf(out, "Name               CPU_Time Pri Arrival_time             Progress CPU_Used MaxRSS_KB Level Demoted Boosted\n");
+        else
+            fprintf(out, "Name               CPU_Time Pri Arrival_time             Progress CPU_Used MaxRSS_KB\n");
+        // only the most recent finished jobs are kept in memory
+        long long i;
+        pthread_mutex_lock(&finished_lock);
+        long long first = recent_head > RECENT_JOBS ? recent_head - RECENT_JOBS : 0;
+        if (first)
+            fprintf(out, "(%lld earlier finished jobs not shown)\n", first);
+        for (i = first; i < recent_head; i++)
         {
 
-            finished_process_p process = finished_process_buffer[i];
+            finished_process_p process = &recent_jobs[i % RECENT_JOBS];
             char *status = "finished";
 
             char *time = convert_time(process->arrival_time);
             remove_newline(time);
-            printf("%-18s %-8d %-3d %s %s\n",
+            fprintf(out, "%-18s %-8.3f %-3d %s %s",
                    process->cmd,
-                   process->cpu_burst,
+                   process->cpu_burst / 1e6,
                    process->priority,
                    time,
                    status);
+            fprintf(out, " %-8.3f %-9ld", (process->user_time + process->system_time) / 1e6, process->max_rss);
+            if (mlfq)
+                fprintf(out, " -     %-7d %d", process->demotions, process->boosts);
+            fputc('\n', out);
         }
+        pthread_mutex_unlock(&finished_lock);
 
-        for (i = 0; i < buf_head; i++)
+        lock_all_workers();
+
+        pthread_mutex_lock(&running_lock);
+
+        // the run queues are only partially ordered heaps, so merge and sort a copy for display
+        u_int total = 0;
+        process_p process;
+        for (process = running_list; process; process = process->next)
+        {
+            total++;
+        }
+        for (i = 0; i < num_workers; i++)
+        {
+            total += workers[i].queue.size;
+        }
+        // jobs waiting for cores or on other jobs are off the run queues, they come last
+        u_int num_parked, num_held;
+        process_p *parked = parked_jobs(&num_parked);
+        process_p *held = held_jobs(&num_held);
+        total += num_parked + num_held;
+
+        process_p *waiting = malloc((total + 1) * sizeof(process_p));
+        u_int n = 0;
+        for (process = running_list; process; process = process->next)
+        {
+            waiting[n++] = process;
+        }
+        u_int running = n;
+        for (i = 0; i < num_workers; i++)
+        {
+            n += rq_snapshot(&workers[i].queue, &waiting[n]);
+        }
+        qsort(&waiting[running], n - running, sizeof(process_p), get_policy_compare());
+        u_int queued = n;
+        memcpy(&waiting[n], parked, num_parked * sizeof(process_p));
+        qsort(&waiting[n], num_parked, sizeof(process_p), get_policy_compare());
+        n += num_parked;
+        u_int waiting_cores = n;
+        memcpy(&waiting[n], held, num_held * sizeof(process_p));
+        qsort(&waiting[n], num_held, sizeof(process_p), get_policy_compare());
+        n += num_held;
+        free(parked);
+        free(held);
+
+        for (i = 0; i < n; i++)
         {
 
-            process_p process = process_buffer[i];
+            process = waiting[i];
             char *status = "-------";
-            if (process->cpu_remaining_burst == 0)
+            if (i < running)
             {
-                continue;
+                status = "running ";
             }
-            else if (process->first_time_on_cpu > 0 && process->cpu_remaining_burst > 0)
+            else if (i >= waiting_cores)
             {
-                status = "running ";
+                status = "held    ";
+            }
+            else if (i >= queued)
+            {
+                status = "parked  ";
+            }
+            else if (process->pid > 0)
+            {
+                status = "stopped ";
             }
 
             char *time = convert_time(process->arrival_time);
             remove_newline(time);
-            printf("%-18s %-8d %-3d %s %s\n",
+            fprintf(out, "%-18s %-8.3f %-3d %s %s",
                    process->cmd,
-                   process->cpu_burst,
+                   process->cpu_burst / 1e6,
                    process->priority,
                    time,
                    status);
+            fprintf(out, " -        -        ");
+            if (mlfq)
+                fprintf(out, " %-5u %-7d %d", process->level, process->demotions, process->boosts);
+            fputc('\n', out);
         }
-        printf("\n");
+        free(waiting);
+
+        pthread_mutex_unlock(&running_lock);
+        unlock_all_workers();
+        fputc('\n', out);
     }
     else
-        printf("No processes loaded yet!\n");
+        fprintf(out, "No processes loaded yet!\n");
+    return 0;
+}
+
+/*
+ * Parses a name[:<value>] distribution option, value is left alone if not given
+ */
+static int parse_distribution(const char *option, const char *name, double *value)
+{
+    size_t length = strlen(name);
+    if (strncmp(option, name, length))
+        return 0;
+    if (option[length] == ':')
+        *value = atof(option + length + 1);
+    else if (option[length] != '\0')
+        return 0;
+    return 1;
+}
+
+/*
+ * Parses the arguments shared by test and simulate into a seeded workload,
+ * both report through the finished job metrics so nothing else may have run yet
+ *
+ * After the seven positional arguments any of these options may follow
+ *   seed=<n>                                      seed for the workload generator, default 0
+ *   arrival=fixed|exp                             fixed gaps or poisson arrivals with <arrival_rate> mean gap
+ *   burst=uniform|pareto[:<alpha>]|lognormal[:<sigma>]  distribution of bursts within the min and max
+ *   priority=uniform|zipf[:<s>]                   distribution of priorities over the levels
+ *   cpus=<max>                                    jobs ask for 1 to <max> cores, uniformly, test only
+ */
+static int parse_benchmark(int nargs, char **argv, workload_t *workload, int *num_of_jobs)
+{
+    if (nargs < 8)
+    {
+        printf("Usage: %s <benchmark> <policy> <num_of_jobs> <arrival_rate> <priority_levels> <min_CPU_time> <max_CPU_time> "
+               "[seed=<n>] [arrival=fixed|exp] [burst=uniform|pareto[:<alpha>]|lognormal[:<sigma>]] [priority=uniform|zipf[:<s>]] [cpus=<max>]\n",
+               argv[0]);
+        return EINVAL;
+    }
+    else if (count || recent_head)
+    {
+        printf("Error: Jobs current in queue / on CPU, no jobs should have ran if doing benchmark...\n");
+        return EINVAL;
+    }
+
+    *num_of_jobs = atoi(argv[3]);
+    memset(workload, 0, sizeof(*workload));
+    workload->arrival = ARRIVAL_FIXED;
+    workload->interarrival = atof(argv[4]);
+    workload->priority_levels = atoi(argv[5]);
+    workload->min_burst = atof(argv[6]);
+    workload->max_burst = atof(argv[7]);
+
+    if (workload->min_burst >= workload->max_burst)
+    {
+        printf("Error: <min_CPU_time> cannot be greater than or equal to <max_CPU_time>\n");
+        return EINVAL;
+    }
+    else if (*num_of_jobs <= 0 || workload->min_burst < 0 || workload->priority_levels < 0 || workload->interarrival < 0)
+    {
+        printf("Error: <num_of_jobs> cannot be equal or less than zero\nError: <min_CPU_time> <max_CPU_time> <arrival_rate> and <priority_levels> must be greater than 0\n");
+        return EINVAL;
+    }
+
+    uint64_t seed = 0; // the same seed each time makes the same jobs
+    double alpha = DEFAULT_PARETO_ALPHA;
+    double sigma = DEFAULT_LOGNORMAL_SIGMA;
+    workload->zipf_s = DEFAULT_ZIPF_S;
+    int i;
+    for (i = 8; i < nargs; i++)
+    {
+        char *option = argv[i];
+        if (!strncmp(option, "seed=", 5))
+            seed = strtoull(option + 5, NULL, 10);
+        else if (!strcmp(option, "arrival=fixed"))
+            workload->arrival = ARRIVAL_FIXED;
+        else if (!strcmp(option, "arrival=exp"))
+            workload->arrival = ARRIVAL_EXPONENTIAL;
+        else if (!strcmp(option, "burst=uniform"))
+            workload->burst = BURST_UNIFORM;
+        else if (parse_distribution(option, "burst=pareto", &alpha))
+            workload->burst = BURST_PARETO;
+        else if (parse_distribution(option, "burst=lognormal", &sigma))
+            workload->burst = BURST_LOGNORMAL;
+        else if (!strcmp(option, "priority=uniform"))
+            workload->priority = PRIORITY_UNIFORM;
+        else if (parse_distribution(option, "priority=zipf", &workload->zipf_s))
+            workload->priority = PRIORITY_ZIPF;
+        else if (!strncmp(option, "cpus=", 5))
+        {
+            placement_t widest = {.cpus = atoi(option + 5)};
+            const char *error = check_placement(&widest);
+            if (widest.cpus <= 0 || error)
+            {
+                printf("Error: %s\n", error ? error : "cpus= needs a positive number of cores");
+                return EINVAL;
+            }
+            workload->max_cpus = widest.cpus;
+        }
+        else
+        {
+            printf("Error: unknown benchmark option %s\n", option);
+            return EINVAL;
+        }
+    }
+
+    workload->burst_shape = workload->burst == BURST_PARETO ? alpha : sigma;
+    if (workload->burst == BURST_PARETO && (workload->min_burst <= 0 || workload->burst_shape <= 0))
+    {
+        printf("Error: pareto bursts need <min_CPU_time> and alpha greater than 0\n");
+        return EINVAL;
+    }
+    if (workload->burst == BURST_LOGNORMAL && workload->burst_shape <= 0)
+    {
+        printf("Error: lognormal bursts need sigma greater than 0\n");
+        return EINVAL;
+    }
+
+    workload_init(workload, seed);
     return 0;
 }
 
@@ -311,73 +640,369 @@ int cmd_list()
 int cmd_test(int nargs, char **argv)
 {
 
-    srand(0); // ensure seed is set to the same value each time to make same jobs created
-    if (nargs != 8)
-    {
-        printf("Usage: test <benchmark> <policy> <num_of_jobs> <arrival_rate> <priority_levels> <min_CPU_time> <max_CPU_time>\n");
+    workload_t workload;
+    int num_of_jobs;
+    if (parse_benchmark(nargs, argv, &workload, &num_of_jobs))
         return EINVAL;
-    }
-    else if (count || finished_head)
+
+    // rr and mlfq keep the settings of the last rr or mlfq command
+    const policy_cmd *entry = find_policy(argv[2]);
+    if (entry == NULL)
     {
-        printf("Error: Jobs current in queue / on CPU, no jobs should have ran if doing benchmark...\n");
+        char names[MAXCMDLINE];
+        policy_names(names, sizeof(names));
+        printf("Error: <policy> must be one of %s\n", names);
+        workload_free(&workload);
         return EINVAL;
     }
-    char *benchmark = argv[1];
-    char *str_policy = argv[2];
-    int num_of_jobs = atoi(argv[3]);
-    int arrival_rate = atoi(argv[4]);
-    int priority_levels = atoi(argv[5]);
-    int min_cpu_burst = atoi(argv[6]);
-    int max_cpu_burst = atoi(argv[7]);
+    policy = entry->policy;
+    change_scheduler();
 
-    if (min_cpu_burst >= max_cpu_burst)
-    {
-        printf("Error: <min_CPU_time> cannot be greater than or equal to <max_CPU_time>\n");
+    test_scheduler(&workload, num_of_jobs);
+    workload_free(&workload);
+    printf("Benchmark is running please wait...\n");
+    wait_for_idle();
+
+    report_metrics(stdout, get_policy_string());
+
+    // clear the finished job metrics
+    // ensures that the metrics aren't reported when quitting aubatch
+    // also ensures if running metrics again that the prior jobs will not interfere
+    reset_metrics();
+
+    return 0;
+}
+
+/*
+ * simulate a benchmark test
+ *
+ * takes the same arguments as test and draws the same jobs, but runs them in
+ * virtual time with no jobs launched. The live policy is left alone so a
+ * policy can be evaluated before switching to it
+ */
+int cmd_simulate(int nargs, char **argv)
+{
+    workload_t workload;
+    int num_of_jobs;
+    if (parse_benchmark(nargs, argv, &workload, &num_of_jobs))
         return EINVAL;
-    }
-    else if (num_of_jobs <= 0 || min_cpu_burst < 0 || max_cpu_burst < 0 || priority_levels < 0 || arrival_rate < 0)
+
+    // every simulated job runs on one slot, a job wider than that would be reported as if it were not
+    if (workload.max_cpus)
     {
-        printf("Error: <num_of_jobs> cannot be equal or less than zero\nError: <min_CPU_time> <max_CPU_time> <arrival_rate> and <priority_levels> must be greater than 0\n");
+        printf("Error: simulate does not model cores, cpus= only works with test\n");
+        workload_free(&workload);
         return EINVAL;
     }
 
+    char *str_policy = argv[2];
+
+    compare_t compare;
+    const char *policy_name;
     if (!strcmp(str_policy, "fcfs"))
     {
-        policy = FCFS;
+        compare = fcfs_scheduler;
+        policy_name = "FCFS (simulated)";
     }
     else if (!strcmp(str_policy, "sjf"))
     {
-        policy = SJF;
+        compare = sjf_scheduler;
+        policy_name = "SJF (simulated)";
     }
     else if (!strcmp(str_policy, "priority"))
     {
-        policy = PRIORITY;
+        compare = priority_scheduler;
+        policy_name = "Priority (simulated)";
     }
     else
     {
         printf("Error: <policy> must be either fcfs, sjf, or priority\n");
+        workload_free(&workload);
         return EINVAL;
     }
 
-    test_scheduler(benchmark, num_of_jobs, arrival_rate, priority_levels, min_cpu_burst, max_cpu_burst);
-    printf("Benchmark is running please wait...\n");
-    while (count)
+    // the simulated jobs are reported on their own and never reach the live metrics
+    simulation_t *simulation = calloc(1, sizeof(simulation_t));
+    if (simulation == NULL)
     {
+        perror("Unable to malloc simulation");
+        exit(1);
     }
+    simulation->metrics = new_metrics();
 
-    report_metrics();
+    long long started = now_ns();
+    long long makespan = simulate_scheduler(simulation, compare, &workload, num_of_jobs);
+    workload_free(&workload);
+    double elapsed = (now_ns() - started) / 1e9;
 
-    // clear process queue and finished queue
-    // ensures that the metrics aren't reported when quitting aubatch
-    // also ensures if running metrics again that the prior jobs will not interfere
-    int i;
-    for (i = 0; i < finished_head; i++)
+    printf("Simulated %d jobs on %u job slots, %.3f seconds of virtual time in %.3f seconds (%.0f jobs/second)\n",
+           num_of_jobs, num_slots, makespan / 1e9, elapsed, elapsed > 0 ? num_of_jobs / elapsed : 0);
+
+    print_metrics(stdout, policy_name, simulation->metrics, simulation->recent, simulation->recent_head, 0);
+
+    free(simulation->metrics);
+    free(simulation);
+    return 0;
+}
+
+/*
+ * replay a recorded trace
+ *
+ * streams a standard workload format or csv trace and submits each job at its
+ * recorded offset under the current policy, then reports like test does.
+ * An optional scale replays the trace that many times faster
+ */
+int cmd_replay(int nargs, char **argv)
+{
+    if (nargs != 2 && nargs != 3)
     {
-        free(finished_process_buffer[i]);
+        printf("Usage: replay <file> [scale]\n");
+        return EINVAL;
+    }
+    else if (count || recent_head)
+    {
+        printf("Error: Jobs current in queue / on CPU, no jobs should have ran if doing benchmark...\n");
+        return EINVAL;
+    }
+
+    double scale = nargs == 3 ? atof(argv[2]) : 1;
+    if (scale <= 0)
+    {
+        printf("Error: <scale> must be greater than 0\n");
+        return EINVAL;
     }
-    finished_head = 0;
-    buf_head = 0;
-    buf_tail = 0;
 
+    printf("Replaying %s under %s, please wait...\n", argv[1], get_policy_string());
+    long long submitted = replay_trace(argv[1], scale);
+    if (submitted < 0)
+    {
+        printf("Error: unable to open trace %s: %s\n", argv[1], strerror(errno));
+        return EINVAL;
+    }
+    printf("Submitted %lld jobs, waiting for them to finish...\n", submitted);
+    wait_for_idle();
+
+    report_metrics(stdout, get_policy_string());
+
+    // like test, the replayed jobs must not show up in later reports
+    reset_metrics();
+
+    return 0;
+}
+
+/*
+ * This function is called when the user enters wait
+ *
+ * Blocks without using the cpu until every job has finished, or with a job
+ * id until that job has finished. Job ids are handed out in submission order
+ * starting at 0
+ */
+int cmd_wait(int nargs, char **argv)
+{
+    if (nargs > 2)
+    {
+        printf("Usage: wait [<job_id>]\n");
+        return EINVAL;
+    }
+
+    if (nargs == 1)
+    {
+        wait_for_idle();
+        printf("All jobs have finished.\n");
+        return 0;
+    }
+
+    char *end;
+    long id = strtol(argv[1], &end, 10);
+    if (*end || id < 0 || id > UINT_MAX)
+    {
+        printf("Error: <job_id> must be a job id\n");
+        return EINVAL;
+    }
+
+    int status = wait_for_job(id);
+    if (status == -1)
+    {
+        printf("Error: no job %ld was submitted\n", id);
+        return EINVAL;
+    }
+    if (status == JOB_UNKNOWN)
+        printf("Job %ld finished before AUbatch restarted or too long ago, its exit status was not kept.\n", id);
+    else
+        printf("Job %ld exited with status %d.\n", id, status);
     return 0;
-}
\ No newline at end of file
+}
+
+typedef struct
+{
+    char **paths;    /* distinct job paths seen so far, NULL for an empty slot */
+    char *runnable;  /* whether the path at the same index can be executed */
+    size_t capacity; /* slots in the table, always a power of two */
+    size_t used;     /* slots holding a path */
+
+} path_cache_t;
+
+/*
+ * FNV-1a hash of a path
+ */
+static size_t hash_path(const char *path)
+{
+    size_t hash = 14695981039346656037ULL;
+    for (; *path; path++)
+    {
+        hash ^= (unsigned char)*path;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * Returns the slot holding path, or the empty slot it belongs in
+ */
+static size_t find_path(path_cache_t *cache, const char *path)
+{
+    size_t slot = hash_path(path) & (cache->capacity - 1);
+    while (cache->paths[slot] && strcmp(cache->paths[slot], path))
+    {
+        slot = (slot + 1) & (cache->capacity - 1);
+    }
+    return slot;
+}
+
+/*
+ * Returns 1 if path can be executed. Each distinct path is only checked once,
+ * a file full of the same job costs a single access()
+ */
+static int check_path(path_cache_t *cache, const char *path)
+{
+    if (cache->used * 2 >= cache->capacity)
+    {
+        // keep the table at most half full, rehash every path into one twice the size
+        path_cache_t grown = {calloc(cache->capacity * 2, sizeof(char *)), calloc(cache->capacity * 2, 1), cache->capacity * 2, cache->used};
+        if (grown.paths == NULL || grown.runnable == NULL)
+        {
+            perror("Unable to grow path cache");
+            exit(1);
+        }
+        size_t i;
+        for (i = 0; i < cache->capacity; i++)
+        {
+            if (cache->paths[i])
+            {
+                size_t slot = find_path(&grown, cache->paths[i]);
+                grown.paths[slot] = cache->paths[i];
+                grown.runnable[slot] = cache->runnable[i];
+            }
+        }
+        free(cache->paths);
+        free(cache->runnable);
+        *cache = grown;
+    }
+
+    size_t slot = find_path(cache, path);
+    if (!cache->paths[slot])
+    {
+        cache->paths[slot] = strdup(path);
+        cache->runnable[slot] = !access(path, X_OK);
+        cache->used++;
+    }
+    return cache->runnable[slot];
+}
+
+static void free_path_cache(path_cache_t *cache)
+{
+    size_t i;
+    for (i = 0; i < cache->capacity; i++)
+    {
+        free(cache->paths[i]);
+    }
+    free(cache->paths);
+    free(cache->runnable);
+}
+
+/*
+ * bulk submit jobs from a file
+ *
+ * each line holds the arguments of a run command, <job> <time> <priority>,
+ * blank lines and lines starting with # are skipped. Jobs are handed to the
+ * workers SUBMIT_CHUNK at a time so each worker lock is taken once per chunk
+ * and idle dispatchers are woken once per chunk. With -f - the lines come from
+ * stdin, up to a line holding a single . or the end of input
+ */
+int cmd_submit(int nargs, char **argv)
+{
+    if (nargs != 3 || strcmp(argv[1], "-f"))
+    {
+        printf("Usage: submit -f <file|->\n");
+        return EINVAL;
+    }
+
+    int from_stdin = !strcmp(argv[2], "-");
+    FILE *file = from_stdin ? stdin : fopen(argv[2], "r");
+    if (file == NULL)
+    {
+        printf("Error: unable to open %s: %s\n", argv[2], strerror(errno));
+        return EINVAL;
+    }
+
+    path_cache_t cache = {calloc(64, sizeof(char *)), calloc(64, 1), 64, 0};
+    process_p *chunk = malloc(SUBMIT_CHUNK * sizeof(process_p));
+    if (cache.paths == NULL || cache.runnable == NULL || chunk == NULL)
+    {
+        perror("Unable to malloc submit buffers");
+        exit(1);
+    }
+
+    char line[MAX_CMD_LEN];
+    long long line_number = 0;
+    long long submitted = 0;
+    long long rejected = 0;
+    int n = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line_number++;
+        remove_newline(line);
+        if (from_stdin && !strcmp(line, "."))
+            break;
+
+        char *context;
+        char *job = strtok_r(line, " \t", &context);
+        if (job == NULL || *job == '#')
+            continue;
+        char *time = strtok_r(NULL, " \t", &context);
+        char *priority = strtok_r(NULL, " \t", &context);
+        if (time == NULL || priority == NULL || strtok_r(NULL, " \t", &context) || atof(time) < 0)
+        {
+            fprintf(stderr, "Line %lld: expected <job> <time> <priority>\n", line_number);
+            rejected++;
+            continue;
+        }
+        if (!check_path(&cache, job))
+        {
+            fprintf(stderr, "Line %lld: %s is not an executable file\n", line_number, job);
+            rejected++;
+            continue;
+        }
+
+        chunk[n++] = new_process(job, (long long)(atof(time) * 1000000 + 0.5), atoi(priority));
+        if (n == SUBMIT_CHUNK)
+        {
+            enqueue_batch(chunk, n);
+            submitted += n;
+            n = 0;
+        }
+    }
+    if (n)
+    {
+        enqueue_batch(chunk, n);
+        submitted += n;
+    }
+
+    if (!from_stdin)
+        fclose(file);
+    free(chunk);
+    free_path_cache(&cache);
+
+    printf("Submitted %lld jobs, %lld lines rejected. Scheduling Policy: %s.\n", submitted, rejected, get_policy_string());
+    return rejected ? EINVAL : 0;
+}
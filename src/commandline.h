@@ -10,20 +10,33 @@
  * Header file for commandline, used by driver
  *
  * Compilation Instruction: 
- * gcc -o aubatch.out aubatch.c commandline.c modules.c -lpthread -Wall
+ * gcc -o aubatch.out aubatch.c commandline.c modules.c queue.c launcher.c metrics.c simulate.c workload.c trace.c channel.c server.c journal.c export.c telemetry.c placement.c dependency.c -lpthread -lm -Wall
  *
  */
 
 #include <assert.h>
+#include <stdio.h>
 #include <sys/wait.h>
 
+#include "modules.h"
+
 /* Error Code */
 #define EINVAL 1
 #define E2BIG 2
 
-#define MAXMENUARGS 8
+#define MAXMENUARGS 16
+#define SUBMIT_CHUNK 1024 /* jobs handed to the workers at once by submit */
 #define MAXCMDLINE 64
 
+typedef struct
+{
+    const char *name;
+    enum scheduling_policies policy;
+    int (*configure)(int nargs, char **args); /* takes the policy's settings from its command, NULL if it has none */
+} policy_cmd;
+
+extern const policy_cmd policy_table[]; /* every scheduling policy by name, ends with a NULL name */
+
 void menu_execute(char *line, int isargs);
 int cmd_run(int nargs, char **args);
 int cmd_quit(int nargs, char **args);
@@ -31,9 +44,14 @@ void showmenu();
 int cmd_helpmenu(int n, char **a);
 int cmd_dispatch(char *cmd);
 void *commandline(void *ptr);
-int cmd_priority();
-int cmd_fcfs();
-int cmd_sjf();
+int cmd_policy(int nargs, char **args);
+const policy_cmd *find_policy(const char *name);
+void policy_names(char *buffer, size_t size);
 int cmd_list();
+int list_jobs(FILE *out);
 int cmd_test(int nargs, char **args);
+int cmd_simulate(int nargs, char **args);
+int cmd_replay(int nargs, char **args);
+int cmd_submit(int nargs, char **args);
+int cmd_wait(int nargs, char **args);
 void change_scheduler();
\ No newline at end of file
@@ -0,0 +1,351 @@
+/*
+ * COMP7500/7506
+ * Project 3: dependency
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Jobs that wait on other jobs, run --after <id,...> waits for every listed
+ * job to succeed and run --afterany <id,...> for them to finish however they
+ * end. A job can only wait on jobs submitted before it, so the jobs and
+ * their dependencies always form a DAG
+ *
+ * Every unfinished job that is waited on, or is waiting, has a node in a
+ * hash table by id, so the table only grows with the jobs in flight. A
+ * waited on job's node lists the jobs waiting on it and a waiting job's node
+ * holds the job and how many of its dependencies are unfinished. A job with
+ * unfinished dependencies is held here instead of joining a run queue.
+ * When a job finishes only its own list is walked, each job on it is
+ * counted down and handed back to be queued when it reaches zero, or handed
+ * back to be cancelled if it needed the job to succeed and it failed
+ *
+ * Whether a dependency has finished is read from the exit status table
+ * under dependency_lock. A job's exit status is set before its dependents
+ * are released, so a dependency is either seen finished or the waiting job
+ * is on its list before the list is walked
+ *
+ */
+
+#include "dependency.h"
+
+typedef struct node
+{
+    u_int id;
+    struct node *chain;       /* next node in the same bucket */
+    process_p process;        /* the held job, NULL if it is not held or was handed back */
+    struct node *prev, *next; /* links in held while process is set */
+    int pending;              /* dependencies of the held job that have not finished */
+    dependency_t *dependents; /* jobs waiting on this one, ok is set for afterok */
+    int num_dependents;
+    int size;                 /* room in dependents */
+
+} node_t;
+
+static pthread_mutex_t dependency_lock = PTHREAD_MUTEX_INITIALIZER; /* guards everything below */
+static node_t **buckets; /* nodes by job id, jobs nobody waits on that are not held have none */
+static u_int num_buckets; /* always a power of two */
+static u_int num_nodes;
+static node_t *held;      /* nodes holding a job, so list can show them */
+static u_int num_held;
+
+/*
+ * Adds the comma separated job ids in list to after, ok for afterok.
+ * Returns NULL or what is wrong with the list
+ */
+static const char *add_dependencies(const char *list, int ok, dependency_t **after, int *num_after)
+{
+    while (1)
+    {
+        char *end;
+        if (*list < '0' || *list > '9')
+            return "--after needs a comma separated list of job ids";
+        unsigned long id = strtoul(list, &end, 10);
+        if (id >= next_id)
+            return "--after names a job that was never submitted";
+        int status;
+        if (ok && poll_job(id, &status) == 1 && status == JOB_UNKNOWN)
+            return "--after names a job whose exit status is no longer kept, use --afterany";
+
+        dependency_t *grown = realloc(*after, (*num_after + 1) * sizeof(dependency_t));
+        if (grown == NULL)
+        {
+            perror("Unable to grow dependency list");
+            exit(1);
+        }
+        *after = grown;
+        (*after)[*num_after].id = id;
+        (*after)[*num_after].ok = ok;
+        (*num_after)++;
+
+        if (*end == '\0')
+            return NULL;
+        if (*end != ',')
+            return "--after needs a comma separated list of job ids";
+        list = end + 1;
+    }
+}
+
+/*
+ * Strips the --after <ids>, --afterok <ids> and --afterany <ids> options
+ * after the command name off args, the options parse_placement knows are
+ * left where they are. after is malloced, NULL if there are none. Returns
+ * NULL if every id was submitted, otherwise what is wrong
+ */
+const char *parse_dependencies(int *nargs, char **args, dependency_t **after, int *num_after)
+{
+    *after = NULL;
+    *num_after = 0;
+
+    int i = 1;
+    while (i + 1 < *nargs && !strncmp(args[i], "--", 2))
+    {
+        int ok;
+        if (!strcmp(args[i], "--after") || !strcmp(args[i], "--afterok"))
+            ok = 1;
+        else if (!strcmp(args[i], "--afterany"))
+            ok = 0;
+        else
+        {
+            i += 2;
+            continue;
+        }
+
+        const char *error = add_dependencies(args[i + 1], ok, after, num_after);
+        if (error)
+        {
+            free(*after);
+            *after = NULL;
+            *num_after = 0;
+            return error;
+        }
+        memmove(&args[i], &args[i + 2], (*nargs - i - 2) * sizeof(char *));
+        *nargs -= 2;
+    }
+    return NULL;
+}
+
+/*
+ * Returns the link pointing at the node of job id, or at the end of its
+ * bucket if it has none. Callers hold dependency_lock and num_buckets is set
+ */
+static node_t **find_node(u_int id)
+{
+    node_t **link = &buckets[id & (num_buckets - 1)];
+    while (*link && (*link)->id != id)
+        link = &(*link)->chain;
+    return link;
+}
+
+/*
+ * Doubles the table once it holds two nodes per bucket, callers hold dependency_lock
+ */
+static void grow_table()
+{
+    u_int old_buckets = num_buckets;
+    node_t **old = buckets;
+
+    num_buckets = num_buckets ? num_buckets * 2 : DEPENDENCY_BUCKETS;
+    buckets = calloc(num_buckets, sizeof(node_t *));
+    if (buckets == NULL)
+    {
+        perror("Unable to grow dependency table");
+        exit(1);
+    }
+
+    u_int i;
+    for (i = 0; i < old_buckets; i++)
+    {
+        node_t *node = old[i];
+        while (node)
+        {
+            node_t *chain = node->chain;
+            node_t **head = &buckets[node->id & (num_buckets - 1)];
+            node->chain = *head;
+            *head = node;
+            node = chain;
+        }
+    }
+    free(old);
+}
+
+/*
+ * Returns the node of job id, NULL if it has none, callers hold dependency_lock
+ */
+static node_t *lookup_node(u_int id)
+{
+    return num_buckets ? *find_node(id) : NULL;
+}
+
+/*
+ * Returns the node of job id, made if it has none, callers hold dependency_lock
+ */
+static node_t *get_node(u_int id)
+{
+    if (num_nodes >= num_buckets * 2)
+        grow_table();
+
+    node_t **link = find_node(id);
+    if (*link == NULL)
+    {
+        *link = calloc(1, sizeof(node_t));
+        if (*link == NULL)
+        {
+            perror("Unable to malloc dependency node");
+            exit(1);
+        }
+        (*link)->id = id;
+        num_nodes++;
+    }
+    return *link;
+}
+
+/*
+ * Puts job id on the list of jobs waiting on node, callers hold dependency_lock
+ */
+static void add_dependent(node_t *node, u_int id, int ok)
+{
+    if (node->num_dependents == node->size)
+    {
+        node->size = node->size ? node->size * 2 : 4;
+        node->dependents = realloc(node->dependents, node->size * sizeof(dependency_t));
+        if (node->dependents == NULL)
+        {
+            perror("Unable to grow dependents");
+            exit(1);
+        }
+    }
+    node->dependents[node->num_dependents].id = id;
+    node->dependents[node->num_dependents].ok = ok;
+    node->num_dependents++;
+}
+
+/*
+ * Takes node's job off held, callers hold dependency_lock
+ */
+static void unhold(node_t *node)
+{
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        held = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+    node->process = NULL;
+    num_held--;
+}
+
+/*
+ * Checks a new job's dependencies. If any is unfinished the job is held
+ * until release_dependents hands it back. A dependency whose exit status is
+ * no longer kept only counts as met for afterany, afterok needs a success
+ */
+int hold_process(process_p process)
+{
+    int pending = 0;
+    int failed = 0;
+    int i;
+
+    pthread_mutex_lock(&dependency_lock);
+    for (i = 0; i < process->num_after && !failed; i++)
+    {
+        dependency_t *after = &process->after[i];
+        int status;
+        if (poll_job(after->id, &status))
+            failed = after->ok && status;
+        else
+        {
+            add_dependent(get_node(after->id), process->id, after->ok);
+            pending++;
+        }
+    }
+
+    // a cancelled job is left on the lists it joined, release_dependents skips it
+    if (!failed && pending)
+    {
+        node_t *node = get_node(process->id);
+        node->process = process;
+        node->pending = pending;
+        node->prev = NULL;
+        node->next = held;
+        if (held)
+            held->prev = node;
+        held = node;
+        num_held++;
+    }
+    pthread_mutex_unlock(&dependency_lock);
+
+    if (failed)
+        return DEPENDENCIES_FAILED;
+    return pending ? DEPENDENCIES_PENDING : DEPENDENCIES_MET;
+}
+
+/*
+ * Job id finished with status. Every held job waiting on it is counted down
+ * and pushed onto ready once nothing is left to wait on, or onto cancelled
+ * if it waited with afterok and status is a failure. The lists are linked
+ * through next. The caller queues the ready jobs and cancels the others,
+ * then calls this again for each cancelled job to cancel its dependents
+ */
+void release_dependents(u_int id, int status, process_p *ready, process_p *cancelled)
+{
+    pthread_mutex_lock(&dependency_lock);
+    node_t **link = num_buckets ? find_node(id) : NULL;
+    node_t *node = link ? *link : NULL;
+    if (node == NULL)
+    {
+        pthread_mutex_unlock(&dependency_lock);
+        return;
+    }
+    *link = node->chain;
+    num_nodes--;
+
+    int i;
+    for (i = 0; i < node->num_dependents; i++)
+    {
+        dependency_t *edge = &node->dependents[i];
+        node_t *dependent = lookup_node(edge->id);
+        if (dependent == NULL || dependent->process == NULL)
+            continue;
+
+        process_p process = dependent->process;
+        if (edge->ok && status)
+        {
+            unhold(dependent);
+            process->next = *cancelled;
+            *cancelled = process;
+        }
+        else if (!--dependent->pending)
+        {
+            unhold(dependent);
+            process->next = *ready;
+            *ready = process;
+        }
+    }
+    pthread_mutex_unlock(&dependency_lock);
+
+    free(node->dependents);
+    free(node);
+}
+
+/*
+ * Returns a malloced copy of the held jobs and their number in n. They stay
+ * valid while the caller holds every worker lock and running_lock, a job
+ * released meanwhile can neither be queued nor retired until those are free
+ */
+process_p *held_jobs(u_int *n)
+{
+    pthread_mutex_lock(&dependency_lock);
+    process_p *jobs = malloc((num_held + 1) * sizeof(process_p));
+    if (jobs == NULL)
+    {
+        perror("Unable to malloc held jobs");
+        exit(1);
+    }
+    *n = 0;
+    node_t *node;
+    for (node = held; node; node = node->next)
+        jobs[(*n)++] = node->process;
+    pthread_mutex_unlock(&dependency_lock);
+    return jobs;
+}
@@ -0,0 +1,33 @@
+/*
+ * COMP7500/7506
+ * Project 3: dependency header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for jobs that wait on other jobs (run --after), used by the
+ * scheduling module, the command line and the socket front end
+ *
+ */
+
+#ifndef DEPENDENCY_H
+#define DEPENDENCY_H
+
+#include "modules.h"
+
+#define DEPENDENCY_BUCKETS 1024 /* initial buckets in the table of jobs by id */
+
+enum hold_results
+{
+    DEPENDENCIES_MET,     /* every job waited on already finished, the job can be queued */
+    DEPENDENCIES_PENDING, /* the job is held until the jobs it waits on finish */
+    DEPENDENCIES_FAILED,  /* a job waited on with afterok failed, the job has to be cancelled */
+};
+
+const char *parse_dependencies(int *nargs, char **args, dependency_t **after, int *num_after); /* strips --after, --afterok and --afterany off a run, NULL or what is wrong */
+int hold_process(process_p process);                                                          /* one of hold_results, a pending job is kept here until it is released */
+void release_dependents(u_int id, int status, process_p *ready, process_p *cancelled);        /* job id finished, adds the held jobs it freed or doomed to the lists */
+process_p *held_jobs(u_int *n);                                                                /* malloced copy of the held jobs, for list */
+
+#endif
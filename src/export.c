@@ -0,0 +1,400 @@
+/*
+ * COMP7500/7506
+ * Project 3: export
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Machine readable output for dashboards and regression checks. The job log
+ * (-l) gets one record per finished job and the summary log (-a) gets the
+ * overall metrics every few seconds, each as csv or as json lines if its name
+ * ends in .jsonl
+ *
+ * Finished jobs are copied onto an in memory queue and a single export
+ * thread formats and writes them, so the thread finishing jobs never waits
+ * on the disk. The queue is two buffers swapped by the export thread, like
+ * the journal
+ *
+ */
+
+#include "export.h"
+#include "metrics.h"
+
+#include <errno.h>
+
+typedef struct
+{
+    FILE *file;
+    int json; /* json lines instead of csv */
+
+} export_log_t;
+
+static export_log_t job_log;      /* every finished job, file is NULL if not enabled */
+static export_log_t summary_log;  /* overall metrics, file is NULL if not enabled */
+static long long summary_ns;      /* nanoseconds between summaries */
+static long long next_summary;    /* now_ns() the next summary is due */
+
+static pthread_mutex_t export_lock = PTHREAD_MUTEX_INITIALIZER; /* guards everything below */
+static pthread_cond_t export_work;                              /* jobs are waiting for the export thread */
+static pthread_cond_t export_done = PTHREAD_COND_INITIALIZER;   /* written moved on */
+static finished_process_t *pending; /* jobs not yet taken by the export thread */
+static size_t pending_len;
+static size_t pending_size;
+static finished_process_t *writing; /* jobs being written, swapped with pending */
+static size_t writing_size;
+static long long queued;            /* jobs ever queued */
+static long long written;           /* jobs ever queued that were written */
+static int started;                 /* the export thread is running */
+
+/*
+ * Writes string as a quoted csv field, quotes inside it are doubled
+ */
+static void write_csv_string(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for (; *string; string++)
+    {
+        if (*string == '"')
+            fputc('"', file);
+        fputc(*string, file);
+    }
+    fputc('"', file);
+}
+
+/*
+ * Writes string as a json string
+ */
+static void write_json_string(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for (; *string; string++)
+    {
+        unsigned char c = *string;
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+/*
+ * Writes one finished job to the job log
+ */
+static void write_job(finished_process_p finished)
+{
+    FILE *file = job_log.file;
+    if (!job_log.json)
+    {
+        fprintf(file, "%u,", finished->id);
+        write_csv_string(file, finished->cmd);
+        fprintf(file, ",%ld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%d,%d,%d,%d,%d,%lld,%lld,%lld,%lld,%lld,%ld,%ld,%ld,%ld,%ld\n",
+                (long)finished->arrival_time,
+                finished->submit_ns,
+                finished->enqueue_ns,
+                finished->dispatch_ns,
+                finished->exec_ns,
+                finished->exit_ns,
+                finished->reaped_ns,
+                finished->cpu_burst,
+                finished->priority,
+                finished->interruptions,
+                finished->demotions,
+                finished->boosts,
+                finished->exit_status,
+                finished->turnaround_time,
+                finished->waiting_time,
+                finished->response_time,
+                finished->user_time,
+                finished->system_time,
+                finished->max_rss,
+                finished->minor_faults,
+                finished->major_faults,
+                finished->voluntary_switches,
+                finished->involuntary_switches);
+        return;
+    }
+
+    fprintf(file, "{\"event\":\"finish\",\"id\":%u,\"cmd\":", finished->id);
+    write_json_string(file, finished->cmd);
+    fprintf(file, ",\"arrival_time\":%ld,\"submit_ns\":%lld,\"enqueue_ns\":%lld,\"dispatch_ns\":%lld,\"exec_ns\":%lld,\"exit_ns\":%lld,\"reaped_ns\":%lld"
+                  ",\"cpu_burst_us\":%lld,\"priority\":%d,\"interruptions\":%d,\"demotions\":%d,\"boosts\":%d,\"exit_status\":%d"
+                  ",\"turnaround_us\":%lld,\"waiting_us\":%lld,\"response_us\":%lld,\"user_us\":%lld,\"system_us\":%lld,\"max_rss_kb\":%ld"
+                  ",\"minor_faults\":%ld,\"major_faults\":%ld,\"voluntary_switches\":%ld,\"involuntary_switches\":%ld}\n",
+            (long)finished->arrival_time,
+            finished->submit_ns,
+            finished->enqueue_ns,
+            finished->dispatch_ns,
+            finished->exec_ns,
+            finished->exit_ns,
+            finished->reaped_ns,
+            finished->cpu_burst,
+            finished->priority,
+            finished->interruptions,
+            finished->demotions,
+            finished->boosts,
+            finished->exit_status,
+            finished->turnaround_time,
+            finished->waiting_time,
+            finished->response_time,
+            finished->user_time,
+            finished->system_time,
+            finished->max_rss,
+            finished->minor_faults,
+            finished->major_faults,
+            finished->voluntary_switches,
+            finished->involuntary_switches);
+}
+
+/*
+ * Writes the mean and percentiles of a series as csv fields or json members
+ */
+static void write_series(FILE *file, int json, const char *name, series_t *series)
+{
+    double values[5] = {
+        stat_mean(&series->stat),
+        series_percentile(series, 50),
+        series_percentile(series, 90),
+        series_percentile(series, 99),
+        (double)atomic_load_explicit(&series->stat.max, memory_order_relaxed)};
+    static const char *suffixes[5] = {"avg", "p50", "p90", "p99", "max"};
+
+    int i;
+    for (i = 0; i < 5; i++)
+    {
+        if (json)
+            fprintf(file, ",\"%s_%s_us\":%.0f", name, suffixes[i], values[i]);
+        else
+            fprintf(file, ",%.0f", values[i]);
+    }
+}
+
+/*
+ * Writes the overall metrics as they stand to the summary log
+ */
+static void write_summary()
+{
+    FILE *file = summary_log.file;
+    int json = summary_log.json;
+    metrics_t *metrics = merge_metrics();
+
+    long long jobs = atomic_load_explicit(&metrics->jobs, memory_order_relaxed);
+    long long first = atomic_load_explicit(&metrics->first_arrival, memory_order_relaxed);
+    long long last = atomic_load_explicit(&metrics->last_finish, memory_order_relaxed);
+    double throughput = jobs && last > first ? jobs / ((last - first) / 1e9) : 0;
+
+    if (json)
+    {
+        fprintf(file, "{\"event\":\"summary\",\"time\":%ld,\"policy\":\"%s\",\"jobs\":%lld,\"failed\":%lld,\"unfinished\":%u,\"throughput\":%.3f",
+                (long)time(NULL), get_policy_string(), jobs,
+                atomic_load_explicit(&metrics->failed, memory_order_relaxed), atomic_load(&count), throughput);
+    }
+    else
+    {
+        fprintf(file, "%ld,%s,%lld,%lld,%u,%.3f",
+                (long)time(NULL), get_policy_string(), jobs,
+                atomic_load_explicit(&metrics->failed, memory_order_relaxed), atomic_load(&count), throughput);
+    }
+    write_series(file, json, "turnaround", &metrics->turnaround);
+    write_series(file, json, "waiting", &metrics->waiting);
+    write_series(file, json, "response", &metrics->response);
+    write_series(file, json, "dispatch_delay", &metrics->dispatch_delay);
+    fputs(json ? "}\n" : "\n", file);
+    fflush(file);
+
+    free(metrics);
+}
+
+/*
+ * Export thread, writes whatever jobs were queued while it wrote the last
+ * batch and the summary whenever one is due
+ */
+static void *exporter(void *ptr)
+{
+    pthread_mutex_lock(&export_lock);
+    while (1)
+    {
+        while (!pending_len && (!summary_log.file || now_ns() < next_summary))
+        {
+            if (summary_log.file)
+            {
+                struct timespec deadline = {next_summary / 1000000000LL, next_summary % 1000000000LL};
+                pthread_cond_timedwait(&export_work, &export_lock, &deadline);
+            }
+            else
+                pthread_cond_wait(&export_work, &export_lock);
+        }
+
+        finished_process_t *jobs = pending;
+        size_t n = pending_len;
+        long long position = queued;
+        pending = writing;
+        pending_len = 0;
+        writing = jobs;
+        size_t jobs_size = pending_size;
+        pending_size = writing_size;
+        writing_size = jobs_size;
+        pthread_mutex_unlock(&export_lock);
+
+        size_t i;
+        for (i = 0; i < n; i++)
+        {
+            write_job(&jobs[i]);
+        }
+        if (n)
+            fflush(job_log.file);
+
+        if (summary_log.file && now_ns() >= next_summary)
+        {
+            write_summary();
+            next_summary += summary_ns;
+            if (next_summary < now_ns())
+                next_summary = now_ns() + summary_ns;
+        }
+
+        pthread_mutex_lock(&export_lock);
+        written = position;
+        pthread_cond_broadcast(&export_done);
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Starts the export thread the first time a log is opened, before any job can finish
+ */
+static int start_exporter()
+{
+    if (started)
+        return 0;
+
+    // summaries are timed on the monotonic clock like everything else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&export_work, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, exporter, (void *)NULL))
+    {
+        perror("Unable to start export thread");
+        return -1;
+    }
+    pthread_detach(thread);
+    started = 1;
+    return 0;
+}
+
+/*
+ * Opens path for appending, json lines if it ends in .jsonl. Returns 1 if
+ * the file is new and needs a header
+ */
+static int open_log(export_log_t *log, const char *path)
+{
+    log->file = fopen(path, "a");
+    if (log->file == NULL)
+    {
+        fprintf(stderr, "Unable to open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    setvbuf(log->file, NULL, _IOFBF, EXPORT_BUFFER);
+
+    size_t length = strlen(path);
+    size_t suffix = strlen(JSONL_SUFFIX);
+    log->json = length >= suffix && !strcmp(path + length - suffix, JSONL_SUFFIX);
+    return ftell(log->file) == 0;
+}
+
+/*
+ * Opens the job log for appending, a csv header is written if the file is new
+ */
+int open_job_log(const char *path)
+{
+    int fresh = open_log(&job_log, path);
+    if (fresh < 0)
+        return -1;
+
+    if (fresh && !job_log.json)
+        fprintf(job_log.file, "id,cmd,arrival_time,submit_ns,enqueue_ns,dispatch_ns,exec_ns,exit_ns,reaped_ns,cpu_burst_us,priority,interruptions,demotions,boosts,exit_status,turnaround_us,waiting_us,response_us,user_us,system_us,max_rss_kb,minor_faults,major_faults,voluntary_switches,involuntary_switches\n");
+    return start_exporter();
+}
+
+/*
+ * Opens the summary log for appending, the overall metrics are added every seconds
+ */
+int open_summary_log(const char *path, int seconds)
+{
+    int fresh = open_log(&summary_log, path);
+    if (fresh < 0)
+        return -1;
+
+    if (fresh && !summary_log.json)
+    {
+        fprintf(summary_log.file, "time,policy,jobs,failed,unfinished,throughput");
+        const char *names[] = {"turnaround", "waiting", "response", "dispatch_delay"};
+        const char *suffixes[] = {"avg", "p50", "p90", "p99", "max"};
+        int i, j;
+        for (i = 0; i < 4; i++)
+        {
+            for (j = 0; j < 5; j++)
+                fprintf(summary_log.file, ",%s_%s_us", names[i], suffixes[j]);
+        }
+        fputc('\n', summary_log.file);
+    }
+    summary_ns = seconds * 1000000000LL;
+    next_summary = now_ns() + summary_ns;
+    return start_exporter();
+}
+
+/*
+ * Queues a finished job for the job log. Only a copy into memory happens
+ * here, the export thread does the formatting and the writing
+ */
+void export_job(finished_process_p finished)
+{
+    if (!job_log.file)
+        return;
+
+    pthread_mutex_lock(&export_lock);
+    if (pending_len == pending_size)
+    {
+        pending_size = pending_size ? pending_size * 2 : EXPORT_BATCH;
+        pending = realloc(pending, pending_size * sizeof(finished_process_t));
+        if (pending == NULL)
+        {
+            perror("Unable to grow export queue");
+            exit(1);
+        }
+    }
+    pending[pending_len++] = *finished;
+    queued++;
+    pthread_cond_signal(&export_work);
+    pthread_mutex_unlock(&export_lock);
+}
+
+/*
+ * Blocks until every job queued so far is in the job log
+ */
+void flush_exports()
+{
+    if (!job_log.file)
+        return;
+
+    pthread_mutex_lock(&export_lock);
+    long long position = queued;
+    pthread_cond_signal(&export_work);
+    while (written < position)
+        pthread_cond_wait(&export_done, &export_lock);
+    pthread_mutex_unlock(&export_lock);
+}
+
+/*
+ * Returns whether finished jobs are being logged
+ */
+int job_log_enabled()
+{
+    return job_log.file != NULL;
+}
@@ -0,0 +1,30 @@
+/*
+ * COMP7500/7506
+ * Project 3: export header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the machine readable job log and summary log, used by the
+ * metrics module and the main driver
+ *
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "modules.h"
+
+#define EXPORT_BUFFER (1 << 20)      /* stdio buffer of each log */
+#define EXPORT_BATCH 1024            /* finished jobs the queue starts with room for */
+#define DEFAULT_SUMMARY_SECONDS 10   /* seconds between summaries until -i is used */
+#define JSONL_SUFFIX ".jsonl"        /* logs with this suffix are written as json lines, others as csv */
+
+int open_job_log(const char *path);                  /* appends a record of every finished job to path */
+int open_summary_log(const char *path, int seconds); /* appends the overall metrics to path every seconds */
+void export_job(finished_process_p finished);        /* queues a finished job for the job log, never waits on disk */
+void flush_exports();                                /* blocks until every queued job is written out */
+int job_log_enabled();                               /* whether finished jobs are being logged */
+
+#endif
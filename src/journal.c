@@ -0,0 +1,776 @@
+/*
+ * COMP7500/7506
+ * Project 3: journal
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Write ahead journal of job submissions, their dependencies, launches and
+ * finishes. With ./aubatch -J <journal> every unfinished job survives aubatch
+ * exiting or crashing and is queued again on the next start
+ *
+ * Records are appended to an in memory buffer and a single writer thread
+ * writes and fsyncs them. While it waits on the disk new records collect in
+ * a second buffer, so one fsync covers every submission that arrived during
+ * the one before it. Submitters only wait for their own records to be on
+ * disk, launches and finishes never wait
+ *
+ * The journal keeps a table of the unfinished jobs it has seen. Once the
+ * journal grows past JOURNAL_COMPACT the table is written out as a snapshot
+ * and the journal starts again empty, so recovery reads at most one snapshot
+ * of unfinished jobs and one bounded journal. Both files start with an epoch
+ * record, a journal whose epoch does not match the snapshot's is left over
+ * from before the last snapshot and is ignored
+ *
+ */
+
+#include "journal.h"
+#include "placement.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <signal.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#define RECORD_HEADER offsetof(journal_record_t, cmd) /* bytes of a record before cmd */
+#define RECORD_MAX (RECORD_HEADER + MAX_CMD_LEN)     /* longest record */
+
+typedef struct journal_job
+{
+    u_int id;
+    int priority;
+    int placement;            /* see pack_placement */
+    pid_t pid;                /* pid of the last launch, 0 if never launched */
+    dependency_t *after;      /* jobs it waits on that have not finished or failed, NULL if none */
+    int num_after;
+    u_int *dependents;        /* jobs that wait on it, NULL if none */
+    int num_dependents;
+    long long cpu_burst;      /* microseconds */
+    time_t arrival_time;
+    struct journal_job *next; /* next job in the same bucket */
+    char cmd[];
+
+} journal_job_t;
+
+static int journal_fd = -1;       /* current journal, -1 when journaling is off */
+static char *journal_path;
+static char *snapshot_path;
+static u_int epoch;               /* epoch of the current snapshot and journal */
+
+static pthread_mutex_t journal_lock = PTHREAD_MUTEX_INITIALIZER;  /* guards everything below */
+static pthread_cond_t journal_work = PTHREAD_COND_INITIALIZER;    /* records are waiting for the writer */
+static pthread_cond_t journal_durable = PTHREAD_COND_INITIALIZER; /* durable moved on */
+static char *pending;             /* records not yet taken by the writer */
+static size_t pending_len;
+static size_t pending_size;
+static char *writing;             /* records being written, swapped with pending */
+static size_t writing_size;
+static long long appended;        /* bytes ever appended */
+static long long durable;         /* bytes ever appended that are on disk */
+static long long journal_size;    /* bytes in the current journal file */
+
+static journal_job_t **buckets;   /* unfinished jobs by id */
+static u_int num_buckets;         /* always a power of two */
+static u_int num_jobs;
+
+/*
+ * FNV-1a hash of size bytes
+ */
+static uint32_t checksum(const void *data, size_t size)
+{
+    const unsigned char *byte = data;
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        hash ^= byte[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Builds a record in out, which needs room for RECORD_MAX bytes, and returns its size
+ */
+static size_t build_record(char *out, u_int type, u_int id, long long value, time_t arrival_time, int priority, int placement, const char *cmd)
+{
+    journal_record_t *record = (journal_record_t *)out;
+    size_t cmd_len = cmd ? strnlen(cmd, MAX_CMD_LEN - 1) + 1 : 0;
+
+    record->size = RECORD_HEADER + cmd_len;
+    record->type = type;
+    record->id = id;
+    record->value = value;
+    record->arrival_time = arrival_time;
+    record->priority = priority;
+    record->placement = placement;
+    if (cmd)
+    {
+        memcpy(record->cmd, cmd, cmd_len - 1);
+        record->cmd[cmd_len - 1] = '\0';
+    }
+    record->checksum = checksum(&record->type, record->size - offsetof(journal_record_t, type));
+    return record->size;
+}
+
+/*
+ * Returns the bucket id lives in
+ */
+static journal_job_t **bucket(u_int id)
+{
+    return &buckets[id & (num_buckets - 1)];
+}
+
+/*
+ * Doubles the table once it holds two jobs per bucket
+ */
+static void grow_table()
+{
+    u_int old_buckets = num_buckets;
+    journal_job_t **old = buckets;
+
+    num_buckets = num_buckets ? num_buckets * 2 : JOURNAL_BUCKETS;
+    buckets = calloc(num_buckets, sizeof(journal_job_t *));
+    if (buckets == NULL)
+    {
+        perror("Unable to grow journal table");
+        exit(1);
+    }
+
+    u_int i;
+    for (i = 0; i < old_buckets; i++)
+    {
+        journal_job_t *job = old[i];
+        while (job)
+        {
+            journal_job_t *next = job->next;
+            journal_job_t **head = bucket(job->id);
+            job->next = *head;
+            *head = job;
+            job = next;
+        }
+    }
+    free(old);
+}
+
+/*
+ * Returns the link pointing at job id, or at the end of its bucket if it is not there
+ */
+static journal_job_t **find_job(u_int id)
+{
+    journal_job_t **link = bucket(id);
+    while (*link && (*link)->id != id)
+        link = &(*link)->next;
+    return link;
+}
+
+/*
+ * Drops job id from the table if it is there
+ */
+static void remove_job(u_int id)
+{
+    journal_job_t **link = find_job(id);
+    journal_job_t *job = *link;
+    if (job == NULL)
+        return;
+    *link = job->next;
+    free(job->after);
+    free(job->dependents);
+    free(job);
+    num_jobs--;
+}
+
+/*
+ * Brings the table of unfinished jobs up to date with one record. Replaying
+ * a record twice leaves the table as replaying it once
+ */
+static void apply_record(const journal_record_t *record)
+{
+    switch (record->type)
+    {
+    case JOURNAL_SUBMIT:
+    {
+        // jobs already linked as waiting on it stay linked
+        journal_job_t *old = *find_job(record->id);
+        u_int *dependents = old ? old->dependents : NULL;
+        int num_dependents = old ? old->num_dependents : 0;
+        if (old)
+            old->dependents = NULL;
+        remove_job(record->id);
+        if (num_jobs >= num_buckets * 2)
+            grow_table();
+
+        size_t cmd_len = strlen(record->cmd) + 1;
+        journal_job_t *job = malloc(sizeof(journal_job_t) + cmd_len);
+        if (job == NULL)
+        {
+            perror("Unable to malloc journal job");
+            exit(1);
+        }
+        job->id = record->id;
+        job->priority = record->priority;
+        job->placement = record->placement;
+        job->pid = 0;
+        job->after = NULL;
+        job->num_after = 0;
+        job->dependents = dependents;
+        job->num_dependents = num_dependents;
+        job->cpu_burst = record->value;
+        job->arrival_time = record->arrival_time;
+        memcpy(job->cmd, record->cmd, cmd_len);
+
+        journal_job_t **head = bucket(job->id);
+        job->next = *head;
+        *head = job;
+        num_jobs++;
+        break;
+    }
+    case JOURNAL_START:
+    {
+        journal_job_t *job = *find_job(record->id);
+        if (job)
+            job->pid = record->value;
+        break;
+    }
+    case JOURNAL_FINISH:
+    {
+        // a met dependency is dropped, a failed one stays so recovery cancels the job
+        journal_job_t *job = *find_job(record->id);
+        int i;
+        for (i = 0; job && i < job->num_dependents; i++)
+        {
+            journal_job_t *dependent = *find_job(job->dependents[i]);
+            int j;
+            for (j = 0; dependent && j < dependent->num_after; j++)
+            {
+                if (dependent->after[j].id == record->id && (!dependent->after[j].ok || !record->value))
+                    dependent->after[j--] = dependent->after[--dependent->num_after];
+            }
+        }
+        remove_job(record->id);
+        break;
+    }
+    case JOURNAL_AFTER:
+    {
+        journal_job_t *job = *find_job(record->id);
+        if (job == NULL)
+            break;
+
+        // a finished job is only named by journal_submit if it failed, afterany does not care
+        journal_job_t *waited = *find_job(record->value);
+        if (waited == NULL && !record->priority)
+            break;
+        if (waited)
+        {
+            u_int *dependents = realloc(waited->dependents, (waited->num_dependents + 1) * sizeof(u_int));
+            if (dependents == NULL)
+            {
+                perror("Unable to grow journal dependents");
+                exit(1);
+            }
+            waited->dependents = dependents;
+            waited->dependents[waited->num_dependents++] = job->id;
+        }
+
+        dependency_t *grown = realloc(job->after, (job->num_after + 1) * sizeof(dependency_t));
+        if (grown == NULL)
+        {
+            perror("Unable to grow journal dependencies");
+            exit(1);
+        }
+        job->after = grown;
+        job->after[job->num_after].id = record->value;
+        job->after[job->num_after].ok = record->priority;
+        job->num_after++;
+        break;
+    }
+    }
+}
+
+/*
+ * Appends a record for the writer and applies it to the table, callers hold journal_lock
+ */
+static void append_record(u_int type, u_int id, long long value, time_t arrival_time, int priority, int placement, const char *cmd)
+{
+    _Alignas(journal_record_t) char record[RECORD_MAX];
+    size_t size = build_record(record, type, id, value, arrival_time, priority, placement, cmd);
+
+    if (pending_len + size > pending_size)
+    {
+        pending_size = pending_size ? pending_size * 2 : JOURNAL_BUFFER;
+        pending = realloc(pending, pending_size);
+        if (pending == NULL)
+        {
+            perror("Unable to grow journal buffer");
+            exit(1);
+        }
+    }
+    memcpy(pending + pending_len, record, size);
+    pending_len += size;
+    appended += size;
+    apply_record((journal_record_t *)record);
+}
+
+/*
+ * Writes all of buffer, exits if the disk refuses as jobs could no longer be recovered
+ */
+static void write_all(int fd, const char *buffer, size_t size)
+{
+    while (size)
+    {
+        ssize_t written = write(fd, buffer, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Unable to write journal");
+            exit(1);
+        }
+        buffer += written;
+        size -= written;
+    }
+}
+
+/*
+ * Flushes the directory holding path so a rename in it is on disk
+ */
+static void sync_directory(const char *path)
+{
+    char *copy = strdup(path);
+    int fd = copy ? open(dirname(copy), O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+    free(copy);
+}
+
+/*
+ * Replaces path with a file holding an epoch record followed by size bytes of
+ * records, the file is complete on disk before it takes path's place. Returns
+ * the new file open for appending if keep is set
+ */
+static int replace_file(const char *path, u_int new_epoch, const char *records, size_t size, int keep)
+{
+    char temp[PATH_MAX];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+
+    int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        perror("Unable to create journal file");
+        exit(1);
+    }
+
+    _Alignas(journal_record_t) char record[RECORD_MAX];
+    size_t header = build_record(record, JOURNAL_EPOCH, new_epoch, next_id, 0, 0, 0, NULL);
+    write_all(fd, record, header);
+    write_all(fd, records, size);
+    if (fdatasync(fd) < 0 || rename(temp, path) < 0)
+    {
+        perror("Unable to replace journal file");
+        exit(1);
+    }
+    sync_directory(path);
+
+    if (!keep)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * Writes the table out as a new snapshot and starts an empty journal in the
+ * next epoch. Callers hold journal_lock, the records still pending are
+ * already in the table so they are dropped
+ */
+static void compact()
+{
+    size_t size = 0;
+    size_t capacity = JOURNAL_BUFFER;
+    char *records = malloc(capacity);
+    if (records == NULL)
+    {
+        perror("Unable to malloc snapshot");
+        exit(1);
+    }
+
+    // every job goes before the dependencies, so reloading links each one to the job it waits on
+    int pass;
+    u_int i;
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < num_buckets; i++)
+        {
+            journal_job_t *job;
+            for (job = buckets[i]; job; job = job->next)
+            {
+                while (size + 2 * RECORD_MAX + job->num_after * RECORD_HEADER > capacity)
+                {
+                    capacity *= 2;
+                    records = realloc(records, capacity);
+                    if (records == NULL)
+                    {
+                        perror("Unable to grow snapshot");
+                        exit(1);
+                    }
+                }
+                if (pass)
+                {
+                    int j;
+                    for (j = 0; j < job->num_after; j++)
+                    {
+                        size += build_record(records + size, JOURNAL_AFTER, job->id, job->after[j].id, 0, job->after[j].ok, 0, NULL);
+                    }
+                    continue;
+                }
+                size += build_record(records + size, JOURNAL_SUBMIT, job->id, job->cpu_burst, job->arrival_time, job->priority, job->placement, job->cmd);
+                if (job->pid)
+                    size += build_record(records + size, JOURNAL_START, job->id, job->pid, 0, 0, 0, NULL);
+            }
+        }
+    }
+
+    // the snapshot goes first, until the new journal replaces the old one the old one is stale
+    epoch++;
+    replace_file(snapshot_path, epoch, records, size, 0);
+    free(records);
+
+    if (journal_fd >= 0)
+        close(journal_fd);
+    journal_fd = replace_file(journal_path, epoch, NULL, 0, 1);
+    journal_size = RECORD_HEADER;
+    pending_len = 0;
+}
+
+/*
+ * Journal writer, writes and fsyncs whatever was appended while it waited on
+ * the previous fsync and wakes the submitters it covered
+ */
+static void *journal_writer(void *ptr)
+{
+    pthread_mutex_lock(&journal_lock);
+    while (1)
+    {
+        while (!pending_len)
+            pthread_cond_wait(&journal_work, &journal_lock);
+
+        long long position = appended;
+        if (journal_size + pending_len > JOURNAL_COMPACT)
+            compact();
+        else
+        {
+            char *records = pending;
+            size_t size = pending_len;
+            pending = writing;
+            pending_len = 0;
+            writing = records;
+            size_t records_size = pending_size;
+            pending_size = writing_size;
+            writing_size = records_size;
+            pthread_mutex_unlock(&journal_lock);
+
+            write_all(journal_fd, records, size);
+            if (fdatasync(journal_fd) < 0)
+            {
+                perror("Unable to sync journal");
+                exit(1);
+            }
+
+            pthread_mutex_lock(&journal_lock);
+            journal_size += size;
+        }
+        durable = position;
+        pthread_cond_broadcast(&journal_durable);
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Applies every intact record of path to the table. A torn or corrupt record
+ * ends the file, it can only be the last write before a crash. Returns the
+ * epoch in epoch_out and next_id in next_out, -1 if the file does not exist
+ */
+static int load_file(const char *path, u_int *epoch_out, u_int *next_out, u_int expect_epoch, int check_epoch)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            return -1;
+        perror("Unable to open journal");
+        exit(1);
+    }
+
+    struct stat info;
+    fstat(fd, &info);
+    char *data = malloc(info.st_size + 1);
+    if (data == NULL)
+    {
+        perror("Unable to malloc journal");
+        exit(1);
+    }
+    size_t size = 0;
+    while (size < info.st_size)
+    {
+        ssize_t got = read(fd, data + size, info.st_size - size);
+        if (got <= 0)
+            break;
+        size += got;
+    }
+    close(fd);
+
+    _Alignas(journal_record_t) char buffer[RECORD_MAX];
+    journal_record_t *record = (journal_record_t *)buffer;
+    size_t offset = 0;
+    long long records = 0;
+    while (offset + RECORD_HEADER <= size)
+    {
+        memcpy(record, data + offset, RECORD_HEADER);
+        if (record->size < RECORD_HEADER || record->size > RECORD_MAX || offset + record->size > size)
+            break;
+        memcpy(record, data + offset, record->size);
+        if (record->checksum != checksum(&record->type, record->size - offsetof(journal_record_t, type)) ||
+            (record->size > RECORD_HEADER && buffer[record->size - 1] != '\0'))
+            break;
+
+        if (!records)
+        {
+            // a journal from before the last snapshot is already folded into it
+            if (record->type != JOURNAL_EPOCH || (check_epoch && record->id != expect_epoch))
+                break;
+            *epoch_out = record->id;
+            if (record->value > *next_out)
+                *next_out = record->value;
+        }
+        else
+        {
+            if (record->type == JOURNAL_SUBMIT && record->id >= *next_out)
+                *next_out = record->id + 1;
+            apply_record(record);
+        }
+        offset += record->size;
+        records++;
+    }
+    if (offset < size && records)
+        fprintf(stderr, "Warning: ignoring %zu bytes at the end of %s written as aubatch stopped\n", size - offset, path);
+    free(data);
+    return 0;
+}
+
+/*
+ * Stops a job that was still running when aubatch stopped. The pid is only
+ * trusted if it still runs the same program, otherwise it was reused
+ */
+static int stop_orphan(journal_job_t *job)
+{
+    char path[64];
+    char cmdline[MAX_CMD_LEN];
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", job->pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+    ssize_t got = read(fd, cmdline, sizeof(cmdline) - 1);
+    close(fd);
+    if (got <= 0)
+        return 0;
+    cmdline[got] = '\0';
+    if (strcmp(cmdline, job->cmd))
+        return 0;
+
+    // jobs run in their own process group, anything they started goes too
+    kill(-job->pid, SIGKILL);
+    return 1;
+}
+
+/*
+ * Orders recovered jobs by id so they are queued in submission order
+ */
+static int by_id(const void *a, const void *b)
+{
+    const journal_job_t *x = *(journal_job_t *const *)a;
+    const journal_job_t *y = *(journal_job_t *const *)b;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/*
+ * Recovers the unfinished jobs recorded in the snapshot and journal at path
+ * and queues them again, then starts journaling to path. Jobs that were
+ * running are stopped if they are still alive and run again from the start.
+ * Called before any worker thread starts
+ */
+int journal_open(const char *path)
+{
+    size_t length = strlen(path);
+    if (length + strlen(SNAPSHOT_SUFFIX) + 5 >= PATH_MAX)
+    {
+        fprintf(stderr, "Journal path %s is too long\n", path);
+        return -1;
+    }
+    journal_path = strdup(path);
+    snapshot_path = malloc(length + strlen(SNAPSHOT_SUFFIX) + 1);
+    if (journal_path == NULL || snapshot_path == NULL)
+    {
+        perror("Unable to malloc journal path");
+        exit(1);
+    }
+    sprintf(snapshot_path, "%s%s", path, SNAPSHOT_SUFFIX);
+    grow_table();
+
+    u_int recovered_next = next_id;
+    int found = !load_file(snapshot_path, &epoch, &recovered_next, 0, 0);
+    found |= !load_file(journal_path, &epoch, &recovered_next, epoch, found);
+
+    process_p *processes = malloc((num_jobs + 1) * sizeof(process_p));
+    journal_job_t **jobs = malloc((num_jobs + 1) * sizeof(journal_job_t *));
+    if (processes == NULL || jobs == NULL)
+    {
+        perror("Unable to malloc recovered jobs");
+        exit(1);
+    }
+    u_int i, n = 0;
+    for (i = 0; i < num_buckets; i++)
+    {
+        journal_job_t *job;
+        for (job = buckets[i]; job; job = job->next)
+            jobs[n++] = job;
+    }
+    qsort(jobs, n, sizeof(journal_job_t *), by_id);
+
+    int orphans = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (jobs[i]->pid > 0)
+        {
+            orphans += stop_orphan(jobs[i]);
+            jobs[i]->pid = 0;
+        }
+        processes[i] = new_process(jobs[i]->cmd, jobs[i]->cpu_burst, jobs[i]->priority);
+        processes[i]->id = jobs[i]->id;
+        processes[i]->arrival_time = jobs[i]->arrival_time;
+        unpack_placement(processes[i], jobs[i]->placement);
+        // the table keeps its copy until the job finishes
+        processes[i]->num_after = jobs[i]->num_after;
+        if (jobs[i]->num_after)
+        {
+            processes[i]->after = malloc(jobs[i]->num_after * sizeof(dependency_t));
+            if (processes[i]->after == NULL)
+            {
+                perror("Unable to malloc recovered dependencies");
+                exit(1);
+            }
+            memcpy(processes[i]->after, jobs[i]->after, jobs[i]->num_after * sizeof(dependency_t));
+        }
+        const char *error = check_placement(&processes[i]->placement);
+        if (error)
+        {
+            // the machine changed since the job was submitted, it floats rather than waiting forever
+            fprintf(stderr, "Warning: job %u runs unpinned, %s\n", processes[i]->id, error);
+            memset(&processes[i]->placement, 0, sizeof(placement_t));
+        }
+    }
+    next_id = recovered_next;
+    restore_job_status(processes, n);
+
+    // journaling is still off, the recovered jobs are already in the table
+    if (n)
+        enqueue_batch(processes, n);
+    if (found)
+        printf("Recovered %u unfinished jobs from %s, %d orphaned jobs were stopped to run again.\n", n, path, orphans);
+    free(jobs);
+    free(processes);
+
+    // start from a snapshot of what was recovered so the old journal is never read again
+    compact();
+
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, journal_writer, (void *)NULL))
+    {
+        perror("Unable to start journal writer");
+        return -1;
+    }
+    pthread_detach(writer);
+    return 0;
+}
+
+/*
+ * Records new jobs, returns the position the caller passes to journal_sync
+ * before telling anyone the jobs were accepted
+ */
+long long journal_submit(process_p *processes, int n)
+{
+    if (journal_fd < 0)
+        return 0;
+
+    pthread_mutex_lock(&journal_lock);
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        process_p process = processes[i];
+        append_record(JOURNAL_SUBMIT, process->id, process->cpu_burst, process->arrival_time, process->priority, pack_placement(process), process->cmd);
+        int j;
+        for (j = 0; j < process->num_after; j++)
+        {
+            // a job that already finished only matters if it failed an afterok, its finish is not journaled again
+            int status;
+            dependency_t *after = &process->after[j];
+            if (poll_job(after->id, &status) != 1 || (after->ok && status))
+                append_record(JOURNAL_AFTER, process->id, after->id, 0, after->ok, 0, NULL);
+        }
+    }
+    long long position = appended;
+    pthread_cond_signal(&journal_work);
+    pthread_mutex_unlock(&journal_lock);
+    return position;
+}
+
+/*
+ * Blocks until every record up to position is on disk
+ */
+void journal_sync(long long position)
+{
+    if (journal_fd < 0)
+        return;
+
+    pthread_mutex_lock(&journal_lock);
+    while (durable < position)
+        pthread_cond_wait(&journal_durable, &journal_lock);
+    pthread_mutex_unlock(&journal_lock);
+}
+
+/*
+ * Records that a job was launched, the pid lets recovery stop it if aubatch
+ * exits while it runs
+ */
+void journal_start(process_p process)
+{
+    if (journal_fd < 0)
+        return;
+
+    pthread_mutex_lock(&journal_lock);
+    append_record(JOURNAL_START, process->id, process->pid, 0, 0, 0, NULL);
+    pthread_cond_signal(&journal_work);
+    pthread_mutex_unlock(&journal_lock);
+}
+
+/*
+ * Records that a job finished, it will not be recovered
+ */
+void journal_finish(u_int id, int status)
+{
+    // recovery cancels jobs before journaling starts, they must not be in the snapshot it takes
+    if (journal_path == NULL)
+        return;
+
+    pthread_mutex_lock(&journal_lock);
+    append_record(JOURNAL_FINISH, id, status, 0, 0, 0, NULL);
+    pthread_cond_signal(&journal_work);
+    pthread_mutex_unlock(&journal_lock);
+}
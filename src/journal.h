@@ -0,0 +1,55 @@
+/*
+ * COMP7500/7506
+ * Project 3: journal header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the write ahead journal that lets unfinished jobs survive
+ * aubatch exiting, used by the scheduling module and the main driver
+ *
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "modules.h"
+
+#include <stdint.h>
+
+#define JOURNAL_COMPACT (64 << 20)  /* journal bytes after which it is folded into a new snapshot */
+#define JOURNAL_BUFFER (1 << 20)    /* initial size of each of the two record buffers */
+#define JOURNAL_BUCKETS 1024        /* initial buckets in the table of unfinished jobs */
+#define SNAPSHOT_SUFFIX ".snap"     /* the snapshot lives next to the journal under this suffix */
+
+enum journal_types
+{
+    JOURNAL_EPOCH = 1, /* first record of a journal or snapshot, value is next_id */
+    JOURNAL_SUBMIT,    /* value is the cpu burst in microseconds */
+    JOURNAL_START,     /* value is the pid of the launched job */
+    JOURNAL_FINISH,    /* value is the exit status */
+    JOURNAL_AFTER,     /* follows the submit of a job run --after, value is an unfinished or failed job it waits on, priority is set for afterok */
+};
+
+typedef struct
+{
+    uint32_t size;        /* bytes in the record, cmd included */
+    uint32_t checksum;    /* fnv-1a of every byte after this field */
+    uint32_t type;        /* one of journal_types */
+    uint32_t id;          /* job id, the epoch for JOURNAL_EPOCH */
+    int64_t value;        /* depends on type, see journal_types */
+    int64_t arrival_time; /* submit only, wall clock submission time */
+    int32_t priority;     /* submit, or for after 1 if the job waited on has to succeed */
+    int32_t placement;    /* submit only, the placement request from pack_placement */
+    char cmd[];           /* submit only, nul terminated */
+
+} journal_record_t;
+
+int journal_open(const char *path);                /* recovers the unfinished jobs in path and starts journaling, 0 on success */
+long long journal_submit(process_p *processes, int n); /* records new jobs, returns the position to pass to journal_sync */
+void journal_sync(long long position);             /* blocks until everything up to position is on disk */
+void journal_start(process_p process);             /* records that a job was launched */
+void journal_finish(u_int id, int status);         /* records that a job finished */
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * COMP7500/7506
+ * Project 3: launcher
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Starts jobs with posix_spawn instead of system. system forks the whole
+ * multithreaded aubatch process, execs /bin/sh and only then execs the job,
+ * and redirections are parsed by the shell. posix_spawn takes the argv
+ * vector as is, sets up redirections with file actions and on Linux uses
+ * vfork semantics, so launching a short job costs a single exec
+ *
+ */
+
+#include "launcher.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+/*
+ * Starts argv[0] with the arguments in argv. If stdout_path is not NULL the
+ * job's stdout is opened on it, otherwise the job shares aubatch's stdout
+ *
+ * Returns 0 and stores the child's pid on success, or the errno value
+ * describing why the job could not be started, including exec failures
+ */
+int launch_job(char *const argv[], const char *stdout_path, pid_t *pid)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t mask;
+    int err;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    if (stdout_path)
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, stdout_path, O_WRONLY, 0);
+
+    // the dispatcher may have signals blocked, jobs should start with a clean mask
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+
+    // each job leads its own process group so it can be stopped and continued as a whole
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+
+    err = posix_spawn(pid, argv[0], &actions, &attr, argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    return err;
+}
+
+/*
+ * Waits for pid to exit and returns its exit status. The resources used by
+ * the job and every child it waited for are stored in usage
+ */
+int reap_job(pid_t pid, struct rusage *usage)
+{
+    int status;
+    while (wait4(pid, &status, 0, usage) < 0)
+    {
+        if (errno != EINTR)
+        {
+            memset(usage, 0, sizeof(*usage));
+            return LAUNCH_FAILED;
+        }
+    }
+    return exit_status(status);
+}
+
+/*
+ * Converts a wait status into a shell style exit status, jobs killed by a
+ * signal report 128 plus the signal number
+ */
+int exit_status(int status)
+{
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    return LAUNCH_FAILED;
+}
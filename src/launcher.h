@@ -0,0 +1,25 @@
+/*
+ * COMP7500/7506
+ * Project 3: launcher header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the job launcher, used by the dispatching module
+ *
+ */
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#define LAUNCH_FAILED 127 /* exit status reported for a job that could not be started, same as the shell */
+
+int launch_job(char *const argv[], const char *stdout_path, pid_t *pid); /* starts argv[0] directly, returns 0 or an errno value */
+int reap_job(pid_t pid, struct rusage *usage);                             /* waits for pid to exit, fills usage and returns its exit status */
+int exit_status(int status);                                               /* converts a wait status into a shell style exit status */
+
+#endif
@@ -0,0 +1,613 @@
+/*
+ * COMP7500/7506
+ * Project 3: metrics
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Provides constant memory job metrics. Every finished job is folded into
+ * running aggregates (count, sum, min, max and variance) and log bucketed
+ * histograms in O(1) and then dropped, only the last RECENT_JOBS jobs are
+ * kept for list and the report. A record of every job can optionally be
+ * appended to an on-disk job log
+ *
+ * Each thread that finishes jobs owns a shard of the metrics and is its only
+ * writer, so recording takes no lock. Shards are merged when reporting
+ *
+ */
+
+#include "metrics.h"
+#include "export.h"
+#include "placement.h"
+
+#include <limits.h>
+#include <math.h>
+
+/* Global shared variables */
+long long recent_head;
+finished_process_t recent_jobs[RECENT_JOBS];
+
+static _Atomic(metrics_t *) shards;    /* every shard ever handed out */
+static _Thread_local metrics_t *shard; /* the shard owned by this thread */
+
+/*
+ * Adds value to a counter only this thread writes, a plain load and store
+ * is enough and keeps the hot path free of locked instructions
+ */
+static void bump(atomic_llong *counter, long long value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static long long load(atomic_llong *counter)
+{
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static double load_double(_Atomic double *value)
+{
+    return atomic_load_explicit(value, memory_order_relaxed);
+}
+
+static void store_double(_Atomic double *value, double new_value)
+{
+    atomic_store_explicit(value, new_value, memory_order_relaxed);
+}
+
+/*
+ * Folds one value into stat in O(1)
+ */
+void stat_add(stat_t *stat, long long value)
+{
+    long long count = load(&stat->count);
+    if (!count || value < load(&stat->min))
+        atomic_store_explicit(&stat->min, value, memory_order_relaxed);
+    if (!count || value > load(&stat->max))
+        atomic_store_explicit(&stat->max, value, memory_order_relaxed);
+
+    count++;
+    atomic_store_explicit(&stat->count, count, memory_order_relaxed);
+    store_double(&stat->sum, load_double(&stat->sum) + value);
+
+    double mean = load_double(&stat->mean);
+    double delta = value - mean;
+    mean += delta / count;
+    store_double(&stat->mean, mean);
+    store_double(&stat->m2, load_double(&stat->m2) + delta * (value - mean));
+}
+
+/*
+ * Folds every value of from into into, the means and variances are combined
+ * with Chan's parallel formula
+ */
+void stat_merge(stat_t *into, stat_t *from)
+{
+    long long from_count = load(&from->count);
+    if (!from_count)
+        return;
+
+    long long into_count = load(&into->count);
+    if (!into_count || load(&from->min) < load(&into->min))
+        atomic_store_explicit(&into->min, load(&from->min), memory_order_relaxed);
+    if (!into_count || load(&from->max) > load(&into->max))
+        atomic_store_explicit(&into->max, load(&from->max), memory_order_relaxed);
+
+    long long count = into_count + from_count;
+    double delta = load_double(&from->mean) - load_double(&into->mean);
+    store_double(&into->mean, load_double(&into->mean) + delta * from_count / count);
+    store_double(&into->m2, load_double(&into->m2) + load_double(&from->m2) + delta * delta * into_count * from_count / count);
+    store_double(&into->sum, load_double(&into->sum) + load_double(&from->sum));
+    atomic_store_explicit(&into->count, count, memory_order_relaxed);
+}
+
+/*
+ * Mean of every value added to stat, 0 if there are none
+ */
+double stat_mean(stat_t *stat)
+{
+    long long count = load(&stat->count);
+    return count ? load_double(&stat->sum) / count : 0;
+}
+
+/*
+ * Population standard deviation of every value added to stat
+ */
+double stat_stddev(stat_t *stat)
+{
+    long long count = load(&stat->count);
+    return count ? sqrt(load_double(&stat->m2) / count) : 0;
+}
+
+/*
+ * Returns the bucket of value. Values below HIST_SUB_BUCKETS get a bucket
+ * each, above that every power of two is split into HIST_SUB_BUCKETS buckets
+ */
+static u_int hist_bucket(long long value)
+{
+    if (value < HIST_SUB_BUCKETS)
+        return value < 0 ? 0 : value;
+
+    int shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+    u_int bucket = (shift + 1) * HIST_SUB_BUCKETS + (value >> shift) - HIST_SUB_BUCKETS;
+    return bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1;
+}
+
+/*
+ * Returns the largest value that lands in bucket
+ */
+static long long hist_upper(u_int bucket)
+{
+    if (bucket < HIST_SUB_BUCKETS)
+        return bucket;
+
+    int shift = bucket / HIST_SUB_BUCKETS - 1;
+    long long top = HIST_SUB_BUCKETS + bucket % HIST_SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+/*
+ * Counts one value in O(1)
+ */
+void hist_add(histogram_t *hist, long long value)
+{
+    atomic_ullong *counter = &hist->counts[hist_bucket(value)];
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/*
+ * Adds every count of from into into
+ */
+void hist_merge(histogram_t *into, histogram_t *from)
+{
+    u_int i;
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        unsigned long long counts = atomic_load_explicit(&from->counts[i], memory_order_relaxed);
+        if (counts)
+            atomic_store_explicit(&into->counts[i], atomic_load_explicit(&into->counts[i], memory_order_relaxed) + counts, memory_order_relaxed);
+    }
+}
+
+/*
+ * Returns the upper bound of the first bucket at which percentile of the
+ * values have been seen, 0 if the histogram is empty
+ */
+long long hist_percentile(histogram_t *hist, double percentile)
+{
+    unsigned long long total = 0;
+    u_int i;
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        total += atomic_load_explicit(&hist->counts[i], memory_order_relaxed);
+    }
+    if (!total)
+        return 0;
+
+    unsigned long long rank = ceil(total * percentile / 100);
+    if (rank < 1)
+        rank = 1;
+
+    unsigned long long seen = 0;
+    for (i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += atomic_load_explicit(&hist->counts[i], memory_order_relaxed);
+        if (seen >= rank)
+            break;
+    }
+    return hist_upper(i < HIST_BUCKETS ? i : HIST_BUCKETS - 1);
+}
+
+static void series_add(series_t *series, long long value)
+{
+    stat_add(&series->stat, value);
+    hist_add(&series->hist, value);
+}
+
+static void series_merge(series_t *into, series_t *from)
+{
+    stat_merge(&into->stat, &from->stat);
+    hist_merge(&into->hist, &from->hist);
+}
+
+/*
+ * Percentile of a series, buckets are wider than one value so the bound is
+ * capped at the exact maximum
+ */
+long long series_percentile(series_t *series, double percentile)
+{
+    long long value = hist_percentile(&series->hist, percentile);
+    long long max = load(&series->stat.max);
+    return value < max ? value : max;
+}
+
+/*
+ * Empties a shard, only done while no job is finishing
+ */
+static void clear_shard(metrics_t *metrics)
+{
+    metrics_t *next = metrics->next;
+    memset(metrics, 0, sizeof(metrics_t));
+    atomic_store_explicit(&metrics->first_arrival, LLONG_MAX, memory_order_relaxed);
+    metrics->next = next;
+}
+
+/*
+ * Returns the shard owned by this thread, the first call from a thread
+ * allocates it and pushes it on the shard list
+ */
+static metrics_t *get_shard()
+{
+    if (shard)
+        return shard;
+
+    shard = malloc(sizeof(metrics_t));
+    if (shard == NULL)
+    {
+        perror("Unable to malloc metrics");
+        exit(1);
+    }
+    shard->next = NULL;
+    clear_shard(shard);
+
+    metrics_t *head = atomic_load(&shards);
+    do
+    {
+        shard->next = head;
+    } while (!atomic_compare_exchange_weak(&shards, &head, shard));
+    return shard;
+}
+
+/*
+ * Merges every shard into metrics, which must be cleared
+ */
+static void merge_shards(metrics_t *metrics)
+{
+    metrics_t *from;
+    for (from = atomic_load(&shards); from; from = from->next)
+    {
+        bump(&metrics->jobs, load(&from->jobs));
+        bump(&metrics->failed, load(&from->failed));
+        bump(&metrics->interruptions, load(&from->interruptions));
+        bump(&metrics->demotions, load(&from->demotions));
+        bump(&metrics->boosts, load(&from->boosts));
+        if (load(&from->first_arrival) < load(&metrics->first_arrival))
+            atomic_store_explicit(&metrics->first_arrival, load(&from->first_arrival), memory_order_relaxed);
+        if (load(&from->last_finish) > load(&metrics->last_finish))
+            atomic_store_explicit(&metrics->last_finish, load(&from->last_finish), memory_order_relaxed);
+        series_merge(&metrics->turnaround, &from->turnaround);
+        series_merge(&metrics->waiting, &from->waiting);
+        series_merge(&metrics->response, &from->response);
+        series_merge(&metrics->burst, &from->burst);
+        series_merge(&metrics->dispatch_delay, &from->dispatch_delay);
+        series_merge(&metrics->launch_delay, &from->launch_delay);
+        series_merge(&metrics->reap_delay, &from->reap_delay);
+        series_merge(&metrics->cpu_time, &from->cpu_time);
+        series_merge(&metrics->max_rss, &from->max_rss);
+        bump(&metrics->user_time, load(&from->user_time));
+        bump(&metrics->system_time, load(&from->system_time));
+        bump(&metrics->minor_faults, load(&from->minor_faults));
+        bump(&metrics->major_faults, load(&from->major_faults));
+        bump(&metrics->voluntary_switches, load(&from->voluntary_switches));
+        bump(&metrics->involuntary_switches, load(&from->involuntary_switches));
+        bump(&metrics->core_time, load(&from->core_time));
+
+        int i;
+        for (i = 0; i < PRIORITY_STATS; i++)
+        {
+            bump(&metrics->priorities[i].jobs, load(&from->priorities[i].jobs));
+            series_merge(&metrics->priorities[i].turnaround, &from->priorities[i].turnaround);
+            series_merge(&metrics->priorities[i].waiting, &from->priorities[i].waiting);
+            series_merge(&metrics->priorities[i].response, &from->priorities[i].response);
+        }
+    }
+}
+
+/*
+ * Folds the times and resource usage of a job that was launched into a shard
+ */
+static void record_times(metrics_t *metrics, finished_process_p finished)
+{
+    bump(&metrics->interruptions, finished->interruptions);
+    bump(&metrics->demotions, finished->demotions);
+    bump(&metrics->boosts, finished->boosts);
+    if (finished->submit_ns < load(&metrics->first_arrival))
+        atomic_store_explicit(&metrics->first_arrival, finished->submit_ns, memory_order_relaxed);
+    if (finished->exit_ns > load(&metrics->last_finish))
+        atomic_store_explicit(&metrics->last_finish, finished->exit_ns, memory_order_relaxed);
+    series_add(&metrics->turnaround, finished->turnaround_time);
+    series_add(&metrics->waiting, finished->waiting_time);
+    series_add(&metrics->response, finished->response_time);
+    series_add(&metrics->burst, finished->cpu_burst);
+
+    // jobs that never made it to a run queue or a launch have no overhead to count
+    if (finished->dispatch_ns && finished->enqueue_ns)
+        series_add(&metrics->dispatch_delay, (finished->dispatch_ns - finished->enqueue_ns) / 1000);
+    if (finished->exec_ns && finished->dispatch_ns)
+        series_add(&metrics->launch_delay, (finished->exec_ns - finished->dispatch_ns) / 1000);
+    series_add(&metrics->reap_delay, (finished->reaped_ns - finished->exit_ns) / 1000);
+
+    series_add(&metrics->cpu_time, finished->user_time + finished->system_time);
+    series_add(&metrics->max_rss, finished->max_rss);
+    bump(&metrics->user_time, finished->user_time);
+    bump(&metrics->system_time, finished->system_time);
+    bump(&metrics->minor_faults, finished->minor_faults);
+    bump(&metrics->major_faults, finished->major_faults);
+    bump(&metrics->voluntary_switches, finished->voluntary_switches);
+    bump(&metrics->involuntary_switches, finished->involuntary_switches);
+    if (finished->exec_ns && finished->exit_ns > finished->exec_ns)
+        bump(&metrics->core_time, finished->cpus * ((finished->exit_ns - finished->exec_ns) / 1000));
+
+    // negative priorities share the first breakdown, high ones the last
+    int priority = finished->priority;
+    if (priority < 0)
+        priority = 0;
+    if (priority >= PRIORITY_STATS)
+        priority = PRIORITY_STATS - 1;
+    priority_metrics_t *by_priority = &metrics->priorities[priority];
+    bump(&by_priority->jobs, 1);
+    series_add(&by_priority->turnaround, finished->turnaround_time);
+    series_add(&by_priority->waiting, finished->waiting_time);
+    series_add(&by_priority->response, finished->response_time);
+}
+
+/*
+ * Folds a finished job into metrics, which only the calling thread writes.
+ * A job cancelled before it was launched only counts as a failed job
+ */
+void add_finished(metrics_t *metrics, finished_process_p finished)
+{
+    bump(&metrics->jobs, 1);
+    if (finished->exit_status)
+        bump(&metrics->failed, 1);
+    if (finished->exit_status != JOB_CANCELLED || finished->exec_ns)
+        record_times(metrics, finished);
+}
+
+/*
+ * Folds a finished job into this thread's shard of the metrics, keeps it in
+ * the recent ring under finished_lock and hands it to the exports
+ */
+void record_finished(finished_process_p finished)
+{
+    add_finished(get_shard(), finished);
+
+    pthread_mutex_lock(&finished_lock);
+    recent_jobs[recent_head % RECENT_JOBS] = *finished;
+    recent_head++;
+
+    pthread_mutex_unlock(&finished_lock);
+
+    // formatting and writing happen on the export thread
+    export_job(finished);
+}
+
+/*
+ * Forgets every finished job, the job log keeps its records. Only called
+ * while no job is running
+ */
+void reset_metrics()
+{
+    metrics_t *metrics;
+    for (metrics = atomic_load(&shards); metrics; metrics = metrics->next)
+    {
+        clear_shard(metrics);
+    }
+
+    pthread_mutex_lock(&finished_lock);
+    recent_head = 0;
+    pthread_mutex_unlock(&finished_lock);
+}
+
+/*
+ * Returns a new empty metrics_t, which the caller frees
+ */
+metrics_t *new_metrics()
+{
+    metrics_t *metrics = malloc(sizeof(metrics_t));
+    if (metrics == NULL)
+    {
+        perror("Unable to malloc metrics");
+        exit(1);
+    }
+    metrics->next = NULL;
+    clear_shard(metrics);
+    return metrics;
+}
+
+/*
+ * Returns every shard merged into a new metrics_t, which the caller frees
+ */
+metrics_t *merge_metrics()
+{
+    metrics_t *metrics = new_metrics();
+    merge_shards(metrics);
+    return metrics;
+}
+
+/*
+ * Prints one row of a percentile table, values are divided by scale
+ */
+static void print_percentiles(FILE *out, const char *name, series_t *series, double scale)
+{
+    fprintf(out, "\t%-16s %-10.3f %-10.3f %-10.3f %-10.3f %-10.3f %-10.3f\n",
+           name,
+           load(&series->stat.min) / scale,
+           series_percentile(series, 50) / scale,
+           series_percentile(series, 90) / scale,
+           series_percentile(series, 99) / scale,
+           series_percentile(series, 99.9) / scale,
+           load(&series->stat.max) / scale);
+}
+
+/*
+ * Returns the wall clock time of a lifecycle stamp, using the wall clock
+ * arrival and the monotonic time since submission
+ */
+static time_t wall_time(finished_process_p finished, long long stamp_ns)
+{
+    return finished->arrival_time + (stamp_ns - finished->submit_ns) / 1000000000LL;
+}
+
+/*
+ * Reports job / process metrics to out. If no jobs are completed then notify user and return
+ * 
+ * Else dump the metrics of the jobs in recent, a ring that head jobs were
+ * put in, and the overall metrics. pending jobs are still to finish
+ */
+void print_metrics(FILE *out, const char *policy_name, metrics_t *metrics, finished_process_t *recent, long long head, long long pending)
+{
+    long long jobs = load(&metrics->jobs);
+    if (!jobs)
+    {
+        fprintf(out, "No jobs completed!\n");
+        return;
+    }
+
+    fprintf(out, "\n=== Reporting Metrics for %s ===\n\n", policy_name);
+
+    // only live jobs reach the job log
+    long long first = head > RECENT_JOBS ? head - RECENT_JOBS : 0;
+    if (first)
+        fprintf(out, "%lld earlier jobs are only counted in the overall metrics%s\n\n", first, recent == recent_jobs && job_log_enabled() ? " and the job log" : "");
+
+    long long i;
+    for (i = first; i < head; i++)
+    {
+        finished_process_p finished_process = &recent[i % RECENT_JOBS];
+
+        fprintf(out, "Metrics for job %s:\n", finished_process->cmd);
+        fprintf(out, "\tCPU Burst:           %.6f seconds\n", finished_process->cpu_burst / 1e6);
+        fprintf(out, "\tInterruptions:       %d times\n", finished_process->interruptions);
+        fprintf(out, "\tDemotions:           %d times\n", finished_process->demotions);
+        fprintf(out, "\tBoosts:              %d times\n", finished_process->boosts);
+        fprintf(out, "\tPriority:            %d\n", finished_process->priority);
+        fprintf(out, "\tExit Status:         %d\n", finished_process->exit_status);
+
+        fprintf(out, "\tArrival Time:        %s", convert_time(finished_process->arrival_time));
+        if (finished_process->exec_ns)
+            fprintf(out, "\tFirst Time on CPU:   %s", convert_time(wall_time(finished_process, finished_process->exec_ns)));
+        else
+            fprintf(out, "\tFirst Time on CPU:   never, cancelled\n");
+        fprintf(out, "\tFinish Time:         %s", convert_time(wall_time(finished_process, finished_process->exit_ns)));
+
+        fprintf(out, "\tTurnaround Time:     %.6f seconds\n", finished_process->turnaround_time / 1e6);
+        fprintf(out, "\tWaiting Time:        %.6f seconds\n", finished_process->waiting_time / 1e6);
+        fprintf(out, "\tResponse Time:       %.6f seconds\n", finished_process->response_time / 1e6);
+        fprintf(out, "\tUser CPU Time:       %.6f seconds\n", finished_process->user_time / 1e6);
+        fprintf(out, "\tSystem CPU Time:     %.6f seconds\n", finished_process->system_time / 1e6);
+        fprintf(out, "\tMax RSS:             %ld KB\n", finished_process->max_rss);
+        fprintf(out, "\tPage Faults:         %ld minor, %ld major\n", finished_process->minor_faults, finished_process->major_faults);
+        fprintf(out, "\tContext Switches:    %ld voluntary, %ld involuntary\n", finished_process->voluntary_switches, finished_process->involuntary_switches);
+        fputc('\n', out);
+    }
+
+    // throughput is measured over the makespan, from the first arrival to the last finish
+    double makespan = (load(&metrics->last_finish) - load(&metrics->first_arrival)) / 1e9;
+
+    fprintf(out, "Overall Metrics for Batch:\n");
+    fprintf(out, "\tTotal Number of Jobs Completed: %lld\n", jobs);
+    fprintf(out, "\tTotal Number of Jobs Submitted: %lld\n", jobs + pending);
+    fprintf(out, "\tTotal Number of Jobs Failed:    %lld\n", load(&metrics->failed));
+    fprintf(out, "\tAverage Turnaround Time:        %.6f seconds\n", stat_mean(&metrics->turnaround.stat) / 1e6);
+    fprintf(out, "\tAverage Waiting Time:           %.6f seconds\n", stat_mean(&metrics->waiting.stat) / 1e6);
+    fprintf(out, "\tAverage Response Time:          %.6f seconds\n", stat_mean(&metrics->response.stat) / 1e6);
+    fprintf(out, "\tAverage CPU Burst:              %.6f seconds\n", stat_mean(&metrics->burst.stat) / 1e6);
+    fprintf(out, "\tTotal CPU Burst:                %.6f seconds\n", load_double(&metrics->burst.stat.sum) / 1e6);
+    fprintf(out, "\tTotal Interruptions:            %lld\n", load(&metrics->interruptions));
+    fprintf(out, "\tTotal Level Demotions:          %lld\n", load(&metrics->demotions));
+    fprintf(out, "\tTotal Level Boosts:             %lld\n", load(&metrics->boosts));
+    fprintf(out, "\tMakespan:                       %.6f seconds\n", makespan);
+    if (makespan > 0)
+    {
+        fprintf(out, "\tThroughput:                     %.3f No./second\n", jobs / makespan);
+        // cores held by jobs over the cores there were, what backfilling is meant to raise
+        fprintf(out, "\tCore Utilisation:               %.1f%% of %d cores\n\n",
+                100 * load(&metrics->core_time) / (makespan * 1e6 * placement_cores()), placement_cores());
+    }
+    else
+        fprintf(out, "\tThroughput:                     n/a\n\n");
+
+    fprintf(out, "\tStd Dev Turnaround Time:        %.6f seconds\n", stat_stddev(&metrics->turnaround.stat) / 1e6);
+    fprintf(out, "\tStd Dev Waiting Time:           %.6f seconds\n", stat_stddev(&metrics->waiting.stat) / 1e6);
+    fprintf(out, "\tStd Dev Response Time:          %.6f seconds\n", stat_stddev(&metrics->response.stat) / 1e6);
+    fprintf(out, "\tStd Dev CPU Burst:              %.6f seconds\n\n", stat_stddev(&metrics->burst.stat) / 1e6);
+
+    // cpu burst is time holding a job slot, cpu time is what the kernel charged the job
+    double burst_sum = load_double(&metrics->burst.stat.sum);
+    fprintf(out, "\tTotal User CPU Time:            %.6f seconds\n", load(&metrics->user_time) / 1e6);
+    fprintf(out, "\tTotal System CPU Time:          %.6f seconds\n", load(&metrics->system_time) / 1e6);
+    if (burst_sum > 0)
+        fprintf(out, "\tCPU Utilisation of Job Slots:   %.1f%%\n", 100 * load_double(&metrics->cpu_time.stat.sum) / burst_sum);
+    fprintf(out, "\tAverage Max RSS:                %.0f KB\n", stat_mean(&metrics->max_rss.stat));
+    fprintf(out, "\tPeak Max RSS:                   %lld KB\n", load(&metrics->max_rss.stat.max));
+    fprintf(out, "\tTotal Page Faults:              %lld minor, %lld major\n", load(&metrics->minor_faults), load(&metrics->major_faults));
+    fprintf(out, "\tTotal Context Switches:         %lld voluntary, %lld involuntary\n\n", load(&metrics->voluntary_switches), load(&metrics->involuntary_switches));
+
+    fprintf(out, "Percentiles for Batch (milliseconds):\n");
+    fprintf(out, "\t%-16s %-10s %-10s %-10s %-10s %-10s %-10s\n", "", "Min", "p50", "p90", "p99", "p99.9", "Max");
+    print_percentiles(out, "Turnaround Time", &metrics->turnaround, 1e3);
+    print_percentiles(out, "Waiting Time", &metrics->waiting, 1e3);
+    print_percentiles(out, "Response Time", &metrics->response, 1e3);
+    print_percentiles(out, "CPU Burst", &metrics->burst, 1e3);
+    print_percentiles(out, "CPU Time", &metrics->cpu_time, 1e3);
+    fputc('\n', out);
+
+    fprintf(out, "Resident Set Size (kilobytes):\n");
+    fprintf(out, "\t%-16s %-10s %-10s %-10s %-10s %-10s %-10s\n", "", "Min", "p50", "p90", "p99", "p99.9", "Max");
+    print_percentiles(out, "Max RSS", &metrics->max_rss, 1);
+    fputc('\n', out);
+
+    fprintf(out, "Scheduler Overhead (microseconds):\n");
+    fprintf(out, "\t%-16s %-10s %-10s %-10s %-10s %-10s %-10s\n", "", "Min", "p50", "p90", "p99", "p99.9", "Max");
+    print_percentiles(out, "Queue to Worker", &metrics->dispatch_delay, 1);
+    print_percentiles(out, "Worker to Launch", &metrics->launch_delay, 1);
+    print_percentiles(out, "Exit to Reaped", &metrics->reap_delay, 1);
+    fputc('\n', out);
+
+    fprintf(out, "Metrics by Priority (milliseconds):\n");
+    fprintf(out, "\t%-8s %-6s %-14s %-14s %-14s %-14s %-14s %-14s\n", "Priority", "Jobs",
+           "Avg Turnaround", "p99 Turnaround", "Avg Waiting", "p99 Waiting", "Avg Response", "p99 Response");
+    int priority;
+    for (priority = 0; priority < PRIORITY_STATS; priority++)
+    {
+        priority_metrics_t *by_priority = &metrics->priorities[priority];
+        if (!load(&by_priority->jobs))
+            continue;
+
+        // the first and last rows also hold the priorities outside the breakdown
+        char label[16];
+        if (priority == PRIORITY_STATS - 1)
+            snprintf(label, sizeof(label), "%d+", priority);
+        else if (priority == 0)
+            snprintf(label, sizeof(label), "<=0");
+        else
+            snprintf(label, sizeof(label), "%d", priority);
+
+        fprintf(out, "\t%-8s %-6lld %-14.3f %-14.3f %-14.3f %-14.3f %-14.3f %-14.3f\n",
+               label,
+               load(&by_priority->jobs),
+               stat_mean(&by_priority->turnaround.stat) / 1e3,
+               series_percentile(&by_priority->turnaround, 99) / 1e3,
+               stat_mean(&by_priority->waiting.stat) / 1e3,
+               series_percentile(&by_priority->waiting, 99) / 1e3,
+               stat_mean(&by_priority->response.stat) / 1e3,
+               series_percentile(&by_priority->response, 99) / 1e3);
+    }
+    fputc('\n', out);
+}
+
+/*
+ * Reports the live jobs to out, the recent jobs still in memory and the
+ * overall metrics merged from every shard
+ */
+void report_metrics(FILE *out, const char *policy_name)
+{
+    flush_exports();
+
+    metrics_t *metrics = merge_metrics();
+    pthread_mutex_lock(&finished_lock);
+    print_metrics(out, policy_name, metrics, recent_jobs, recent_head, count);
+    pthread_mutex_unlock(&finished_lock);
+    free(metrics);
+}
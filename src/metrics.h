@@ -0,0 +1,112 @@
+/*
+ * COMP7500/7506
+ * Project 3: metrics header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for job metrics, used by the dispatching module and commandline
+ *
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "modules.h"
+
+#define RECENT_JOBS 32 /* finished jobs kept in memory for list and the report */
+
+#define HIST_SUB_BITS 5                                                  /* 32 buckets per power of two, about 3% precision */
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)                            /* buckets per power of two */
+#define HIST_MAX_BITS 44                                                 /* values past 2^44us, about 200 days, land in the last bucket */
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS) /* buckets in one histogram */
+#define PRIORITY_STATS 8                                                 /* priorities with their own breakdown, higher ones share the last */
+
+typedef struct
+{
+    atomic_llong count; /* number of values added */
+    atomic_llong min;   /* smallest value added */
+    atomic_llong max;   /* largest value added */
+    _Atomic double sum;  /* sum of every value added */
+    _Atomic double mean; /* running mean, updated with Welford's method */
+    _Atomic double m2;   /* running sum of squared differences from the mean */
+
+} stat_t;
+
+typedef struct
+{
+    atomic_ullong counts[HIST_BUCKETS]; /* log bucketed counts, linear below HIST_SUB_BUCKETS */
+
+} histogram_t;
+
+typedef struct
+{
+    stat_t stat;         /* exact count, min, max, mean and variance */
+    histogram_t hist;    /* approximate distribution for percentiles */
+
+} series_t;
+
+typedef struct
+{
+    atomic_llong jobs; /* finished jobs at this priority */
+    series_t turnaround;
+    series_t waiting;
+    series_t response;
+
+} priority_metrics_t;
+
+typedef struct metrics
+{
+    atomic_llong jobs;          /* finished jobs */
+    atomic_llong failed;        /* finished jobs with a non zero exit status */
+    atomic_llong interruptions; /* preemptions over every finished job */
+    atomic_llong demotions;     /* mlfq level drops over every finished job */
+    atomic_llong boosts;        /* mlfq boosts over every finished job */
+    atomic_llong first_arrival; /* earliest submit_ns of a finished job, LLONG_MAX if none */
+    atomic_llong last_finish;   /* latest exit_ns of a finished job */
+    series_t turnaround;        /* every series is in microseconds */
+    series_t waiting;
+    series_t response;
+    series_t burst;
+    series_t dispatch_delay; /* enqueue to dispatch, scheduler overhead */
+    series_t launch_delay;   /* dispatch to launch, spawn overhead */
+    series_t reap_delay;     /* exit to reaped, supervisor overhead */
+    series_t cpu_time;       /* user plus system cpu time from wait4 */
+    series_t max_rss;        /* peak resident set size in kilobytes */
+    atomic_llong user_time;            /* user cpu time over every finished job */
+    atomic_llong system_time;          /* system cpu time over every finished job */
+    atomic_llong minor_faults;         /* page faults served without io */
+    atomic_llong major_faults;         /* page faults that needed io */
+    atomic_llong voluntary_switches;   /* context switches from blocking */
+    atomic_llong involuntary_switches; /* context switches from kernel preemption */
+    atomic_llong core_time;            /* cores held times time running over every finished job, in core microseconds */
+    priority_metrics_t priorities[PRIORITY_STATS];
+    struct metrics *next; /* next shard, every thread that finishes jobs owns one */
+
+} metrics_t;
+
+// aggregate prototypes, a stat or histogram only has one writer
+void stat_add(stat_t *stat, long long value);    /* folds one value into stat in O(1) */
+void stat_merge(stat_t *into, stat_t *from);     /* folds every value of from into into */
+double stat_mean(stat_t *stat);                  /* mean of every value added */
+double stat_stddev(stat_t *stat);                /* population standard deviation of every value added */
+void hist_add(histogram_t *hist, long long value);      /* counts one value in O(1) */
+void hist_merge(histogram_t *into, histogram_t *from);  /* adds every count of from into into */
+long long hist_percentile(histogram_t *hist, double percentile); /* smallest bucket bound covering percentile of the values */
+long long series_percentile(series_t *series, double percentile); /* hist_percentile capped at the largest value */
+
+// finished job prototypes
+void add_finished(metrics_t *metrics, finished_process_p finished); /* folds a finished job into metrics only, such as a simulation's */
+void record_finished(finished_process_p finished); /* folds a finished job into this thread's metrics and the exports */
+void reset_metrics();                              /* forgets every finished job, used between benchmarks */
+void report_metrics(FILE *out, const char *policy_name); /* prints the recent jobs and the overall metrics to out */
+void print_metrics(FILE *out, const char *policy_name, metrics_t *metrics, finished_process_t *recent, long long head, long long pending); /* report_metrics for metrics kept apart */
+metrics_t *new_metrics();                          /* empty metrics, the caller frees them */
+metrics_t *merge_metrics();                        /* every thread's metrics merged into one, the caller frees it */
+
+/* Global shared variables, guarded by finished_lock */
+extern long long recent_head;                       /* number of jobs put in recent_jobs since the last reset */
+extern finished_process_t recent_jobs[RECENT_JOBS]; /* ring of the most recently finished jobs */
+
+#endif
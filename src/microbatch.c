@@ -8,10 +8,13 @@
  * Date: March 9, 2020. Version 1.0
  *
  * Example program to be called by aubatch, simply sleeps for argv[2] time
- * This assumes argv[2] is a number
+ * This assumes argv[2] is a number of seconds, fractions are allowed
  * 
  * If you were to call ./microbatch 10 it would simply sleep for 10 seconds
  * 
+ * Only time spent running counts, if aubatch preempts the job with SIGSTOP
+ * the time it spends stopped is not taken off the 10 seconds
+ * 
  * Compilation Instruction: 
  * gcc -o microbatch.out microbatch.c
  *
@@ -20,6 +23,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
+
+#define TICK_NS 10000000LL /* sleep in 10ms ticks so stopped time can be told apart */
 
 void remove_newline(char *buffer)
 {
@@ -30,6 +36,28 @@ void remove_newline(char *buffer)
     }
 }
 
+/*
+ * Sleeps for seconds of running time. A tick that took more than twice as long
+ * as asked for means the process was stopped part way, only the tick is counted
+ */
+void run_for(double seconds)
+{
+    long long remaining = seconds * 1000000000LL;
+    while (remaining > 0)
+    {
+        long long tick = remaining < TICK_NS ? remaining : TICK_NS;
+        struct timespec request = {0, tick};
+        struct timespec before, after;
+
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        nanosleep(&request, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+
+        long long elapsed = (after.tv_sec - before.tv_sec) * 1000000000LL + (after.tv_nsec - before.tv_nsec);
+        remaining -= elapsed < 2 * tick ? elapsed : tick;
+    }
+}
+
 int main(int argc, char **argv)
 {
 
@@ -40,7 +68,7 @@ int main(int argc, char **argv)
 
     remove_newline(argv[1]);
 
-    sleep(atoi(argv[1]));
+    run_for(atof(argv[1]));
 
     return 0;
 }
@@ -10,363 +10,1611 @@
  * Provides implemenation for the scheduling module and the dispatching module
  *
  * Compilation Instruction: 
- * gcc -o aubatch.out aubatch.c commandline.c modules.c -lpthread -Wall
+ * gcc -o aubatch.out aubatch.c commandline.c modules.c queue.c launcher.c metrics.c simulate.c workload.c trace.c channel.c server.c journal.c export.c telemetry.c placement.c dependency.c -lpthread -lm -Wall
  *
  */
 
 #include "modules.h"
+#include "launcher.h"
+#include "journal.h"
+#include "telemetry.h"
+#include "placement.h"
+#include "dependency.h"
+#include "metrics.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+/* Global shared variables */
+enum scheduling_policies policy;
+atomic_uint count;
+atomic_uint next_id;
+u_int num_workers;
+u_int num_slots;
+atomic_uint free_slots;
+u_int quantum_ms = DEFAULT_QUANTUM_MS;
+u_int mlfq_quanta[MLFQ_MAX_LEVELS] = {250, 500, 1000};
+u_int mlfq_levels = 3;
+u_int boost_ms = DEFAULT_BOOST_MS;
+
+worker_t *workers;
+process_p running_list;
+
+pthread_mutex_t finished_lock;
+pthread_mutex_t running_lock;
+
+static int supervisor_epoll;  /* epoll instance watching the pidfd of every running job */
+static int supervisor_wakeup; /* eventfd used to make the supervisor recheck its timers */
+static long long last_boost;  /* now_ns() of the last mlfq boost */
+
+static atomic_uint next_worker; /* round robin cursor used to spread new jobs across workers */
+static atomic_uint next_queued; /* stamped on a process each time it joins a run queue */
+
+static pthread_mutex_t completion_lock = PTHREAD_MUTEX_INITIALIZER; /* guards completions, job_status and count going down */
+static pthread_cond_t completion = PTHREAD_COND_INITIALIZER;        /* broadcast every time a job finishes */
+static unsigned long long completions; /* jobs finished so far */
+static short *job_status;              /* exit status of ids status_base on, by id % JOB_STATUS_WINDOW */
+static u_int status_base;              /* lowest id job_status covers, older ids are stragglers or unknown */
+static struct straggler
+{
+    u_int id;
+    short status; /* JOB_PENDING until the job finishes */
+    short aged;   /* the window moved once since it finished, it goes the next time */
+} *stragglers;                         /* jobs below status_base that were unfinished when the window passed them, by id */
+static u_int num_stragglers;
+static u_int stragglers_size;
+static int completion_fd = -1;         /* eventfd written on every completion, only once asked for */
+
+static void notify_completion(u_int id, int status);
+static void settle_dependents(process_p ready, process_p cancelled);
+
+static channel_t submissions;                    /* new processes waiting for the scheduler stage */
+static int stage_wakeup;                         /* eventfd the scheduler stage sleeps on */
+static atomic_int stage_idle;                    /* the stage found no submissions and is about to sleep */
+static process_p staged[SUBMIT_CHANNEL_SIZE];    /* processes the stage drained in one pass */
+
+/*
+ * Draws the next benchmark job from the workload, the caller sets its id and
+ * arrival. test and simulate share this so both see the same jobs for a seed
+ */
+process_p new_test_process(workload_t *workload)
+{
+    process_p process = calloc(1, sizeof(process_t));
+    if (process == NULL)
+    {
+        perror("Unable to malloc process");
+        exit(1);
+    }
+
+    strcpy(process->cmd, "./microbatch.out");
+    process->priority = workload_priority(workload);
+    process->cpu_burst = workload_burst(workload);
+    process->cpu_remaining_burst = process->cpu_burst;
+    process->placement.cpus = workload_cpus(workload);
+    return process;
+}
+
+/*
+ * This function takes in arguments from command line when users select test
+ * 
+ * Simulates a benchmark against a certain scheduling algorithm which is picked in command line
+ * Can take in a number of jobs at once and can load them all at once
+ * 
+ * If the mean interarrival time is > 0 then each job is loaded, dispatcher is notified and then we sleep
+ * for an interarrival time drawn from the workload. After sleeping we load the next job, if there is one
+ */
+void test_scheduler(workload_t *workload, int num_of_jobs)
+{
+    // if arrival rate is 0 all the jobs are built first and handed over as one batch
+    // so the dispatchers only ever see the fully ordered batch
+    int arrival_rate = workload->interarrival > 0;
+    process_p *batch = NULL;
+    if (!arrival_rate)
+        batch = malloc(num_of_jobs * sizeof(process_p));
+
+    // create jobs based on num_of_jobs
+    int i;
+    for (i = 0; i < num_of_jobs; i++)
+    {
+        process_p process = new_test_process(workload);
+        process->id = next_id++;
+        process->arrival_time = time(NULL);
+        process->submit_ns = now_ns();
+
+        if (arrival_rate)
+        {
+            // if there is an arrival rate, notify dispatcher immediately and then sleep until the next arrival
+            enqueue_process(process);
+            if (i + 1 < num_of_jobs)
+            {
+                long long gap = workload_interarrival(workload);
+                struct timespec request = {gap / 1000000000LL, gap % 1000000000LL};
+                while (nanosleep(&request, &request) < 0 && errno == EINTR)
+                {
+                }
+            }
+        }
+        else
+            batch[i] = process;
+    }
+    if (!arrival_rate) // if arrival rate is 0, load all the jobs and then notify the dispatchers
+    {
+        enqueue_batch(batch, num_of_jobs);
+        free(batch);
+    }
+}
+/* 
+ * This function takes in arguments from command line when users select run
+ * 
+ * Takes in one job / process at a time and notifies dispatcher there is a new job
+ */
+void scheduler(int argc, char **argv, placement_t *placement, dependency_t *after, int num_after)
+{
+    process_p process = get_process(argv);
+    process->placement = *placement;
+    process->after = after;
+    process->num_after = num_after;
+
+    // print information about job
+    submit_job(process);
+
+    enqueue_process(process);
+}
+
+/*
+ * Posts a wakeup to a worker, the pending flag covers the window between
+ * the worker deciding to sleep and it actually waiting on its condition
+ */
+static void wake_worker(u_int worker)
+{
+    pthread_mutex_lock(&workers[worker].lock);
+    workers[worker].pending = 1;
+    pthread_cond_signal(&workers[worker].wakeup);
+    pthread_mutex_unlock(&workers[worker].lock);
+}
+
+/*
+ * Wakes one idle worker, starting the search at worker. Busy workers are left
+ * alone as they look for more work as soon as their current job finishes
+ */
+static void wake_idle_worker(u_int worker)
+{
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        u_int candidate = (worker + i) % num_workers;
+        if (workers[candidate].idle)
+        {
+            wake_worker(candidate);
+            return;
+        }
+    }
+}
+
+/*
+ * Picks the worker a new job is queued on. An idle worker is preferred,
+ * otherwise jobs are spread round robin
+ */
+static u_int pick_worker()
+{
+    u_int start = next_worker++ % num_workers;
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        u_int candidate = (start + i) % num_workers;
+        if (workers[candidate].idle)
+            return candidate;
+    }
+    return start;
+}
+
+/*
+ * Pushes a process onto a worker's run queue, callers hold the worker's lock.
+ * The queued stamp is what round robin orders on
+ */
+static void queue_on(worker_t *worker, process_p process)
+{
+    if (!process->enqueue_ns)
+        process->enqueue_ns = now_ns();
+    process->queued = next_queued++;
+    rq_push(&worker->queue, process);
+    worker->depth++;
+    worker->queued_burst += process->cpu_remaining_burst;
+}
+
+/*
+ * Pops the next process off a worker's run queue, callers hold the worker's
+ * lock. A queued process's remaining burst does not change, so the total
+ * goes down by what queue_on added
+ */
+static process_p pop_from(worker_t *worker)
+{
+    process_p process = rq_pop(&worker->queue);
+    if (process)
+    {
+        worker->depth--;
+        worker->queued_burst -= process->cpu_remaining_burst;
+    }
+    return process;
+}
+
+/*
+ * Puts a process on one worker's run queue. Only that worker's lock is taken,
+ * so submitters rarely contend with each other or with the dispatchers
+ */
+static void push_process(process_p process)
+{
+    u_int worker = pick_worker();
+
+    pthread_mutex_lock(&workers[worker].lock);
+    queue_on(&workers[worker], process);
+    pthread_mutex_unlock(&workers[worker].lock);
+
+    wake_idle_worker(worker);
+}
+
+/*
+ * Queues again the processes in a list linked through next, in list order
+ */
+void requeue_processes(process_p processes)
+{
+    while (processes)
+    {
+        process_p next = processes->next;
+        push_process(processes);
+        processes = next;
+    }
+}
+
+/*
+ * Hands a batch of processes to the workers, each worker's lock is taken once
+ * for its whole share of the batch and every idle worker is woken afterwards
+ */
+static void queue_batch(process_p *processes, int n)
+{
+    if (n == 1)
+        push_process(processes[0]);
+    else
+    {
+        u_int start = next_worker++ % num_workers;
+        int i, j;
+        for (i = 0; i < num_workers && i < n; i++)
+        {
+            u_int worker = (start + i) % num_workers;
+            pthread_mutex_lock(&workers[worker].lock);
+            for (j = i; j < n; j += num_workers)
+            {
+                queue_on(&workers[worker], processes[j]);
+            }
+            pthread_mutex_unlock(&workers[worker].lock);
+        }
+
+        for (i = 0; i < num_workers; i++)
+        {
+            if (workers[i].idle)
+                wake_worker(i);
+        }
+    }
+
+    // under srtf a new arrival may be shorter than a running job
+    if (policy == SRTF)
+        wake_supervisor();
+}
+
+/*
+ * Wakes the scheduler stage if it is sleeping. The fence pairs with the one
+ * in scheduler_stage so either the stage sees the new submission or the
+ * submitter sees the stage is idle
+ */
+static void wake_stage()
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_exchange(&stage_idle, 0))
+        return;
+
+    uint64_t one = 1;
+    if (write(stage_wakeup, &one, sizeof(one)) < 0)
+        perror("Unable to wake scheduler stage");
+}
+
+/*
+ * Takes the jobs that wait on unfinished jobs out of processes, they are held
+ * until those finish, and cancels the ones waiting on a job that already
+ * failed. The jobs left to queue are moved to the front, returns how many
+ */
+static int hold_batch(process_p *processes, int n)
+{
+    int i;
+    int ready = 0;
+    for (i = 0; i < n; i++)
+    {
+        process_p process = processes[i];
+        int result = process->num_after ? hold_process(process) : DEPENDENCIES_MET;
+        if (result == DEPENDENCIES_MET)
+        {
+            processes[ready++] = process;
+            continue;
+        }
+
+        telemetry_hold(process);
+        if (result == DEPENDENCIES_FAILED)
+        {
+            process->next = NULL;
+            settle_dependents(NULL, process);
+        }
+    }
+    return ready;
+}
+
+/*
+ * Hands a new process to the dispatchers through the submission channel, or
+ * holds it if it waits on unfinished jobs.
+ * Never waits on the dispatchers, if the channel is full the submitter
+ * queues the process itself. With a journal it waits for the group commit
+ * covering the process
+ */
+void enqueue_process(process_p process)
+{
+    long long position = journal_submit(&process, 1);
+    telemetry_submit(&process, 1);
+
+    count++;
+    if (hold_batch(&process, 1))
+    {
+        if (channel_push(&submissions, process))
+            queue_batch(&process, 1);
+        else
+            wake_stage();
+    }
+
+    // the job may already be running, the submitter only returns once it would survive a crash
+    journal_sync(position);
+}
+
+/*
+ * Hands a batch of processes to the dispatchers. The batch becomes visible to
+ * the scheduler stage all at once so it is queued in one pass, batches that
+ * do not fit in the channel are queued by the submitter
+ */
+void enqueue_batch(process_p *processes, int n)
+{
+    long long position = journal_submit(processes, n);
+    telemetry_submit(processes, n);
+
+    count += n;
+    n = hold_batch(processes, n);
+    if (n && channel_push_many(&submissions, (void **)processes, n))
+        queue_batch(processes, n);
+    else if (n)
+        wake_stage();
+
+    journal_sync(position);
+}
+
+/*
+ * Scheduler stage, the single consumer of the submission channel. Everything
+ * submitted since its last pass is drained and spread over the workers' run
+ * queues in one go, so submitters only ever pay for a push
+ */
+void *scheduler_stage(void *ptr)
+{
+    while (1)
+    {
+        int n = 0;
+        process_p process;
+        while (n < SUBMIT_CHANNEL_SIZE && (process = channel_pop(&submissions)))
+        {
+            staged[n++] = process;
+        }
+        if (n)
+        {
+            queue_batch(staged, n);
+            continue;
+        }
+
+        // announce the stage is going to sleep, then look once more so a push
+        // that raced with the announcement is not missed
+        stage_idle = 1;
+        atomic_thread_fence(memory_order_seq_cst);
+        process = channel_pop(&submissions);
+        if (process)
+        {
+            stage_idle = 0;
+            queue_batch(&process, 1);
+            continue;
+        }
+
+        uint64_t wakeups;
+        while (read(stage_wakeup, &wakeups, sizeof(wakeups)) < 0 && errno == EINTR)
+        {
+        }
+        stage_idle = 0;
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Takes the next process for a worker off its own run queue. To keep the
+ * global policy order roughly intact the head of one neighbouring queue is
+ * also checked, if it should run first it is taken instead. The neighbour is
+ * only try locked so this never waits on another worker
+ */
+static process_p take_local(u_int worker)
+{
+    worker_t *self = &workers[worker];
+    process_p process = NULL;
+
+    pthread_mutex_lock(&self->lock);
+    process_p local = rq_peek(&self->queue);
+
+    if (num_workers > 1)
+    {
+        self->neighbour = (self->neighbour + 1) % num_workers;
+        if (self->neighbour == worker)
+            self->neighbour = (self->neighbour + 1) % num_workers;
+
+        worker_t *other = &workers[self->neighbour];
+        if (other->depth && !pthread_mutex_trylock(&other->lock))
+        {
+            process_p remote = rq_peek(&other->queue);
+            if (remote && (!local || other->queue.compare(&remote, &local) < 0))
+                process = pop_from(other);
+            pthread_mutex_unlock(&other->lock);
+        }
+    }
+
+    if (!process && local)
+        process = pop_from(self);
+    pthread_mutex_unlock(&self->lock);
+    return process;
+}
+
+/*
+ * Steals the next process from the busiest other worker, queue depths are
+ * read without locks and only used as a hint
+ */
+static process_p steal(u_int thief)
+{
+    u_int victim = thief;
+    u_int most = 0;
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        if (i != thief && workers[i].depth > most)
+        {
+            most = workers[i].depth;
+            victim = i;
+        }
+    }
+    if (victim == thief)
+        return NULL;
+
+    pthread_mutex_lock(&workers[victim].lock);
+    process_p process = pop_from(&workers[victim]);
+    pthread_mutex_unlock(&workers[victim].lock);
+    return process;
+}
+
+/*
+ * Returns 1 if any run queue has waiting processes
+ */
+static int work_available()
+{
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        if (workers[i].depth)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Claims one of the job slots, returns 0 if every slot is in use
+ */
+static int claim_slot()
+{
+    u_int slots = free_slots;
+    while (slots)
+    {
+        if (atomic_compare_exchange_weak(&free_slots, &slots, slots - 1))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Dispatcher worker, one of num_workers. Once a job slot is free it pulls the
+ * next job off its own run queue, or steals one from a busy worker when its own
+ * queue is empty, and launches it. The worker does not wait for the job, the
+ * supervisor picks it up when it exits and frees the slot again
+ *
+ * ptr carries the worker index into workers
+ */
+void *dispatcher(void *ptr)
+{
+    u_int worker = (u_int)(uintptr_t)ptr;
+    worker_t *self = &workers[worker];
+
+    while (1)
+    {
+        process_p process = NULL;
+        if (claim_slot())
+        {
+            process = take_local(worker);
+            if (!process)
+                process = steal(worker);
+            if (!process)
+                free_slots++;
+        }
+
+        if (!process)
+        {
+            // advertise idle before the final check, a submitter or the supervisor
+            // either sees the flag and wakes us or we see its change here
+            pthread_mutex_lock(&self->lock);
+            self->idle = 1;
+            while (!self->pending && !(free_slots && work_available()))
+            {
+                pthread_cond_wait(&self->wakeup, &self->lock);
+            }
+            self->pending = 0;
+            self->idle = 0;
+            pthread_mutex_unlock(&self->lock);
+            continue;
+        }
+
+        // a job whose cores are all taken, or under backfill would delay an older one, is parked
+        // until some are released, its slot goes to the next job
+        process_p requeue = NULL;
+        if ((process->placement.cpus || policy == BACKFILL) && !process->claim && claim_cpus(process, &requeue))
+        {
+            free_slots++;
+            requeue_processes(requeue);
+            continue;
+        }
+
+        if (!process->claim)
+            requeue = drop_reservation(process);
+        requeue_processes(requeue);
+        if (!process->dispatch_ns)
+            process->dispatch_ns = now_ns();
+        telemetry_dispatch(process);
+        start_process(process);
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds
+ */
+long long now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+ * Takes a process off the running list, callers hold running_lock
+ */
+static void unlink_running(process_p process)
+{
+    if (process->prev)
+        process->prev->next = process->next;
+    else
+        running_list = process->next;
+    if (process->next)
+        process->next->prev = process->prev;
+    process->running = 0;
+}
+
+/*
+ * Adds the time since the process was last put on the cpu to its run time
+ */
+static void account_slice(process_p process, long long now)
+{
+    process->ran_ns += now - process->slice_start;
+    process->cpu_remaining_burst = process->cpu_burst - process->ran_ns / 1000;
+    if (process->cpu_remaining_burst < 0)
+        process->cpu_remaining_burst = 0;
+}
+
+/*
+ * Stops a process whose time slice expired and puts it back on a run queue.
+ * The whole process group is stopped and we wait for the stop to be reported,
+ * if the job exited first it is finished instead. The process was already
+ * taken off the running list and out of the supervisor's epoll set
+ */
+static void preempt_process(process_p process)
+{
+    int status;
+    struct rusage usage;
+
+    kill(-process->pid, SIGSTOP);
+    while (wait4(process->pid, &status, WUNTRACED, &usage) < 0)
+    {
+        if (errno != EINTR)
+        {
+            status = 0;
+            memset(&usage, 0, sizeof(usage));
+            break;
+        }
+    }
+
+    if (!WIFSTOPPED(status))
+    {
+        process->exit_ns = now_ns();
+        close(process->pidfd);
+        finish_process(process, exit_status(status), &usage);
+        return;
+    }
+
+    account_slice(process, now_ns());
+    process->interruptions++;
+    telemetry_preempt(process);
+
+    free_slots++;
+    push_process(process);
+}
+
+/*
+ * Returns the length of the time slice a running process gets under the
+ * current policy, -1 if it runs until it finishes
+ */
+static long long slice_ms(process_p process)
+{
+    if (policy == RR)
+        return quantum_ms;
+    if (policy == MLFQ)
+        return mlfq_quanta[process->level < mlfq_levels ? process->level : mlfq_levels - 1];
+    return -1;
+}
+
+/*
+ * Returns how many milliseconds the supervisor can wait before the next time
+ * slice expires or the next mlfq boost is due, -1 if neither can happen
+ */
+static int next_timeout()
+{
+    if (policy != RR && policy != MLFQ)
+        return -1;
+
+    long long now = now_ns();
+    long long earliest = -1;
+    if (policy == MLFQ)
+        earliest = last_boost + boost_ms * 1000000LL;
+
+    pthread_mutex_lock(&running_lock);
+    process_p process;
+    for (process = running_list; process; process = process->next)
+    {
+        long long expires = process->slice_start + slice_ms(process) * 1000000LL;
+        if (process->pidfd >= 0 && (earliest < 0 || expires < earliest))
+            earliest = expires;
+    }
+    pthread_mutex_unlock(&running_lock);
+
+    if (earliest < 0)
+        return -1;
+    // round up so the supervisor never wakes just before the deadline
+    return earliest > now ? (int)((earliest - now + 999999) / 1000000) : 0;
+}
+
+/*
+ * Preempts every running process whose time slice has expired. If nothing is
+ * waiting to run the process simply starts a new slice, there is no one to
+ * hand the cpu to. Expired processes are collected under running_lock and
+ * stopped after it is released since requeueing takes worker locks
+ *
+ * Under mlfq a process that used its whole slice drops a level either way
+ */
+static void expire_slices()
+{
+    if (policy != RR && policy != MLFQ)
+        return;
+
+    long long now = now_ns();
+    process_p expired = NULL;
+
+    pthread_mutex_lock(&running_lock);
+    process_p process = running_list;
+    while (process)
+    {
+        process_p next = process->next;
+        if (process->pidfd >= 0 && now - process->slice_start >= slice_ms(process) * 1000000LL)
+        {
+            if (policy == MLFQ && process->level + 1 < mlfq_levels)
+            {
+                process->level++;
+                process->demotions++;
+            }
+
+            if (work_available())
+            {
+                epoll_ctl(supervisor_epoll, EPOLL_CTL_DEL, process->pidfd, NULL);
+                unlink_running(process);
+                process->next = expired;
+                expired = process;
+            }
+            else
+            {
+                account_slice(process, now);
+                process->slice_start = now;
+            }
+        }
+        process = next;
+    }
+    pthread_mutex_unlock(&running_lock);
+
+    while (expired)
+    {
+        process = expired;
+        expired = expired->next;
+        preempt_process(process);
+    }
+}
+
+/*
+ * Periodic mlfq boost, every waiting and running process goes back to the top
+ * level so long running jobs are not starved by a stream of short ones
+ */
+static void check_boost()
+{
+    long long now = now_ns();
+    if (policy != MLFQ || now - last_boost < boost_ms * 1000000LL)
+        return;
+    last_boost = now;
+
+    int i, j;
+    for (i = 0; i < num_workers; i++)
+    {
+        pthread_mutex_lock(&workers[i].lock);
+        ready_queue_t *queue = &workers[i].queue;
+        process_p *waiting = malloc((queue->size + 1) * sizeof(process_p));
+        u_int n = rq_snapshot(queue, waiting);
+        for (j = 0; j < n; j++)
+        {
+            if (waiting[j]->level)
+            {
+                waiting[j]->level = 0;
+                waiting[j]->boosts++;
+            }
+        }
+        free(waiting);
+        rq_reorder(queue, get_policy_compare(), get_policy_levels());
+        pthread_mutex_unlock(&workers[i].lock);
+    }
+
+    pthread_mutex_lock(&running_lock);
+    process_p process;
+    for (process = running_list; process; process = process->next)
+    {
+        if (process->level)
+        {
+            process->level = 0;
+            process->boosts++;
+        }
+    }
+    pthread_mutex_unlock(&running_lock);
+}
+
+/*
+ * Returns how long a process still has to run in nanoseconds, counting the
+ * current slice if it is on the cpu
+ */
+static long long remaining_ns(process_p process, long long now)
+{
+    long long remaining = process->cpu_burst * 1000LL - process->ran_ns;
+    if (process->running)
+        remaining -= now - process->slice_start;
+    return remaining;
+}
+
+/*
+ * Returns the shortest remaining time of any waiting process, -1 if none are
+ * waiting. Under srtf every run queue is ordered by remaining burst so only
+ * the heads need to be checked
+ */
+static long long shortest_waiting_ns(long long now)
+{
+    long long shortest = -1;
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        pthread_mutex_lock(&workers[i].lock);
+        process_p head = rq_peek(&workers[i].queue);
+        if (head && (shortest < 0 || remaining_ns(head, now) < shortest))
+            shortest = remaining_ns(head, now);
+        pthread_mutex_unlock(&workers[i].lock);
+    }
+    return shortest;
+}
+
+/*
+ * Shortest remaining time first. While every job slot is taken and a waiting
+ * process has less time left than a running one, the running process with the
+ * most time left is preempted. Preempting frees a slot, which ends the loop
+ * until the shorter process has been dispatched
+ */
+static void check_srtf()
+{
+    while (policy == SRTF && !free_slots)
+    {
+        long long now = now_ns();
+        long long longest = shortest_waiting_ns(now);
+        if (longest < 0)
+            return;
+
+        process_p victim = NULL;
+        pthread_mutex_lock(&running_lock);
+        process_p process;
+        for (process = running_list; process; process = process->next)
+        {
+            if (process->pidfd >= 0 && remaining_ns(process, now) > longest)
+            {
+                longest = remaining_ns(process, now);
+                victim = process;
+            }
+        }
+        if (victim)
+        {
+            epoll_ctl(supervisor_epoll, EPOLL_CTL_DEL, victim->pidfd, NULL);
+            unlink_running(victim);
+        }
+        pthread_mutex_unlock(&running_lock);
+
+        if (!victim)
+            return;
+        preempt_process(victim);
+    }
+}
+
+/*
+ * Makes the supervisor recheck its timers, used when the policy or quantum changes
+ */
+void wake_supervisor()
+{
+    uint64_t one = 1;
+    if (write(supervisor_wakeup, &one, sizeof(one)) < 0)
+        perror("Unable to wake supervisor");
+}
+
+/*
+ * Supervisor, watches every running job through its pidfd. When a job exits its
+ * pidfd becomes readable, the job is reaped and finished straight away and its
+ * slot is handed back to the dispatchers. One thread covers any number of
+ * running jobs
+ *
+ * Under round robin and mlfq the supervisor also preempts jobs whose time slice
+ * ran out, under srtf it preempts jobs that have more time left than a waiting
+ * job and under mlfq it periodically boosts every job back to the top level
+ */
+void *supervisor(void *ptr)
+{
+    struct epoll_event events[64];
+
+    while (1)
+    {
+        int n = epoll_wait(supervisor_epoll, events, 64, next_timeout());
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Supervisor epoll_wait failed");
+            exit(1);
+        }
+
+        int i;
+        for (i = 0; i < n; i++)
+        {
+            process_p process = events[i].data.ptr;
+            if (process == NULL)
+            {
+                uint64_t wakeups;
+                if (read(supervisor_wakeup, &wakeups, sizeof(wakeups)) < 0)
+                    perror("Unable to read supervisor wakeup");
+                continue;
+            }
+
+            process->exit_ns = now_ns();
+            epoll_ctl(supervisor_epoll, EPOLL_CTL_DEL, process->pidfd, NULL);
+            close(process->pidfd);
+
+            struct rusage usage;
+            int status = reap_job(process->pid, &usage);
+            finish_process(process, status, &usage);
+        }
+
+        expire_slices();
+        check_srtf();
+        check_boost();
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Sets up the supervisor's epoll instance, done before any worker can launch a job
+ */
+void init_supervisor()
+{
+    supervisor_epoll = epoll_create1(EPOLL_CLOEXEC);
+    supervisor_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    if (supervisor_epoll < 0 || supervisor_wakeup < 0 ||
+        epoll_ctl(supervisor_epoll, EPOLL_CTL_ADD, supervisor_wakeup, &event) < 0)
+    {
+        perror("Unable to create supervisor epoll");
+        exit(1);
+    }
+    free_slots = num_slots;
+    last_boost = now_ns();
+}
+
+/*
+ * Sets up the run queue, lock and wakeup condition for every worker and the
+ * submission channel that feeds them
+ */
+void init_workers()
+{
+    workers = calloc(num_workers, sizeof(worker_t));
+    if (workers == NULL)
+    {
+        perror("Unable to malloc workers");
+        exit(1);
+    }
+
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        pthread_mutex_init(&workers[i].lock, NULL);
+        pthread_cond_init(&workers[i].wakeup, NULL);
+        rq_init(&workers[i].queue, get_policy_compare());
+        workers[i].neighbour = i;
+    }
+    pthread_mutex_init(&running_lock, NULL);
+    init_placement();
+
+    channel_init(&submissions, SUBMIT_CHANNEL_SIZE);
+    stage_wakeup = eventfd(0, EFD_CLOEXEC);
+    if (stage_wakeup < 0)
+    {
+        perror("Unable to create scheduler stage wakeup");
+        exit(1);
+    }
+}
+
+/*
+ * Locks every worker in index order, used by the few paths that need a
+ * consistent view of all run queues such as list and policy changes
+ */
+void lock_all_workers()
+{
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        pthread_mutex_lock(&workers[i].lock);
+    }
+}
 
 /*
- * This function takes in arguments from command line when users select test
- * 
- * Simulates a benchmark against a certain scheduling algorithm which is picked in command line
- * Can take in a number of jobs at once and can load them all at once
- * 
- * If arrival rate is > 0 then the jobs are loaded, dispatcher is notified and then we sleep for arrival_time seconds
- * After sleeping we load the next job, if there is one
+ * Releases the locks taken by lock_all_workers
  */
-void test_scheduler(char *benchmark, int num_of_jobs, int arrival_rate, int priority_levels, int min_CPU_time, int max_CPU_time)
+void unlock_all_workers()
 {
-    if (!arrival_rate)
-        batch = 1;
-    else
-        batch = 0;
-
-    // create jobs based on num_of_jobs
-    int i;
-    for (i = 0; i < num_of_jobs; i++)
+    int i = num_workers;
+    while (i-- > 0)
     {
-        if (i >= CMD_BUF_SIZE)
-        // if i is larger than cmd_buff we need to notify dispatcher earlier
-        // without this we would be stuck forever
-        {
-            pthread_cond_signal(&cmd_buf_not_empty);
-        }
+        pthread_mutex_unlock(&workers[i].lock);
+    }
+}
 
-        /* lock the shared command queue */
-        pthread_mutex_lock(&cmd_queue_lock);
+/*
+ * Returns the number of online cpus, used as the default worker count
+ */
+u_int get_default_workers()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (u_int)cpus : 1;
+}
 
-        while (count == CMD_BUF_SIZE)
-        {
-            pthread_cond_wait(&cmd_buf_not_full, &cmd_queue_lock);
-        }
+/*
+ * Calculates the estimated wait time for a process about to be queued
+ *
+ * The running processes plus every waiting process are shared out across the
+ * job slots. Only the running list and each worker's queued total are read,
+ * no run queue is locked, so the estimate costs the same however many jobs
+ * wait. Policies that let the process overtake queued jobs may start it
+ * sooner than this. If a slot will be free by the time the process reaches
+ * the front there is no wait
+ */
+long long calculate_wait()
+{
+    long long wait = 0;
+    u_int ahead = 0;
 
-        pthread_mutex_unlock(&cmd_queue_lock);
+    pthread_mutex_lock(&running_lock);
+    process_p running;
+    for (running = running_list; running; running = running->next)
+    {
+        wait += running->cpu_remaining_burst;
+        ahead++;
+    }
+    pthread_mutex_unlock(&running_lock);
 
-        process_p process = malloc(sizeof(process_t));
+    int i;
+    for (i = 0; i < num_workers; i++)
+    {
+        wait += atomic_load_explicit(&workers[i].queued_burst, memory_order_relaxed);
+        ahead += workers[i].depth;
+    }
 
-        int priority = (rand() % (priority_levels + 1)) + 1;
-        int cpu_burst = (rand() % (max_CPU_time + 1)) + min_CPU_time;
-        strcpy(process->cmd, "./microbatch.out");
-        process->arrival_time = time(NULL);
-        process->cpu_burst = cpu_burst;
-        process->cpu_remaining_burst = cpu_burst;
-        process->priority = priority;
-        process->interruptions = 0;
-        process->first_time_on_cpu = 0;
-        process_buffer[buf_head] = process;
-
-        count++;
-        /* Move buf_head forward, this is a circular queue */
-        buf_head++;
-        // sort before moding buf_head, without this if you were to sort CMD_BUF_SIZE items it would break
-        sort_buffer(process_buffer);
-        buf_head %= CMD_BUF_SIZE;
-
-        pthread_mutex_unlock(&cmd_queue_lock);
+    if (ahead < num_slots)
+        return 0;
+    return wait / num_slots;
+}
 
-        if (arrival_rate)
-        {
-            // if there is an arrival rate, notify dispatcher immediately and then sleep for arrival_rate
-            pthread_cond_signal(&cmd_buf_not_empty);
-            sleep(arrival_rate); // wait for the arrival rate
-        }
-    }
-    if (!arrival_rate) // if arrival rate is 0, load all the jobs and then notify dispatcher
+/*
+ * Builds a process submitted now, cpu_burst is in microseconds
+ */
+process_p new_process(const char *cmd, long long cpu_burst, int priority)
+{
+    process_p process = calloc(1, sizeof(process_t));
+    if (process == NULL)
     {
-        /* Unlock the shared command queue */
-        pthread_cond_signal(&cmd_buf_not_empty);
+        perror("Unable to malloc process");
+        exit(1);
     }
+
+    // load process structure
+    snprintf(process->cmd, MAX_CMD_LEN, "%s", cmd);
+    process->id = next_id++;
+    process->arrival_time = time(NULL);
+    process->submit_ns = now_ns();
+    process->cpu_burst = cpu_burst;
+    process->cpu_remaining_burst = process->cpu_burst;
+    process->priority = priority;
+    process->interruptions = 0;
+    process->pid = 0;
+    process->running = 0;
+    process->ran_ns = 0;
+    return process;
 }
-/* 
- * This function takes in arguments from command line when users select run
- * 
- * Takes in one job / process at a time and notifies dispatcher there is a new job
+
+/*
+ * Loads process via argv, this is called when `run` is specified in the command line
+ */
+process_p get_process(char **argv)
+{
+    remove_newline(argv[3]);
+    // fractional seconds are allowed
+    return new_process(argv[1], (long long)(atof(argv[2]) * 1000000 + 0.5), atoi(argv[3]));
+}
+
+/*
+ * Puts a process on the running list, callers hold running_lock
+ */
+static void link_running(process_p process)
+{
+    process->prev = NULL;
+    process->next = running_list;
+    if (running_list)
+        running_list->prev = process;
+    running_list = process;
+    process->running = 1;
+}
+
+/*
+ * Starts a process with the launcher, or resumes it if it was preempted, and
+ * hands it to the supervisor. The process goes on the running list and into the
+ * supervisor's epoll set under running_lock so the supervisor never sees one
+ * without the other
  */
-void scheduler(int argc, char **argv)
+void start_process(process_p process)
 {
-    /* lock the shared command queue */
-    pthread_mutex_lock(&cmd_queue_lock);
+    if (process->pid > 0)
+    {
+        resume_process(process);
+        return;
+    }
 
-    while (count == CMD_BUF_SIZE)
+    char burst[32];
+    char *argv[] = {process->cmd, NULL, NULL};
+    const char *stdout_path = "/dev/null";
+    if (!strcmp(process->cmd, "./microbatch.out"))
     {
-        pthread_cond_wait(&cmd_buf_not_full, &cmd_queue_lock);
+        // microbatch is told how long to run for in seconds and keeps aubatch's stdout
+        sprintf(burst, "%lld.%06lld", process->cpu_remaining_burst / 1000000, process->cpu_remaining_burst % 1000000);
+        argv[1] = burst;
+        stdout_path = NULL;
     }
 
-    pthread_mutex_unlock(&cmd_queue_lock);
-    process_p process = get_process(argv);
+    process->slice_start = now_ns();
+    if (process->placement.cpus)
+        pin_launcher(process);
+    int err = launch_job(argv, stdout_path, &process->pid);
+    if (process->placement.cpus)
+        unpin_launcher();
+    process->exec_ns = now_ns();
+    telemetry_launch(process, err);
+    if (err)
+    {
+        fprintf(stderr, "Error: unable to launch %s: %s\n", process->cmd, strerror(err));
+        finish_process(process, LAUNCH_FAILED, NULL);
+        return;
+    }
 
-    // print information about job
-    submit_job(process->cmd);
+    journal_start(process);
 
-    process_buffer[buf_head] = process;
-    pthread_mutex_lock(&cmd_queue_lock);
+    process->pidfd = syscall(SYS_pidfd_open, process->pid, 0);
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = process};
 
-    count++;
+    pthread_mutex_lock(&running_lock);
+    link_running(process);
+    if (process->pidfd >= 0 && epoll_ctl(supervisor_epoll, EPOLL_CTL_ADD, process->pidfd, &event) < 0)
+    {
+        close(process->pidfd);
+        process->pidfd = -1;
+    }
+    pthread_mutex_unlock(&running_lock);
+
+    if (process->pidfd < 0)
+    {
+        // without a pidfd this worker has to wait for the job itself, it is never preempted
+        struct rusage usage;
+        int status = reap_job(process->pid, &usage);
+        finish_process(process, status, &usage);
+    }
+    else if (slice_ms(process) >= 0)
+        wake_supervisor(); // the supervisor has to time the new slice
+}
+
+/*
+ * Puts a preempted process back on the cpu. It is watched again before it is
+ * continued, if it was killed while stopped the supervisor reaps it right away
+ */
+void resume_process(process_p process)
+{
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = process};
+
+    telemetry_resume(process);
 
-    /* Move buf_head forward, this is a circular queue */
-    buf_head++;
-    // ensure buffer is in accordance to current policy
-    sort_buffer(process_buffer);
-    buf_head %= CMD_BUF_SIZE;
+    pthread_mutex_lock(&running_lock);
+    process->slice_start = now_ns();
+    link_running(process);
+    epoll_ctl(supervisor_epoll, EPOLL_CTL_ADD, process->pidfd, &event);
+    pthread_mutex_unlock(&running_lock);
 
-    /* Unlock the shared command queue */
-    pthread_cond_signal(&cmd_buf_not_empty);
-    pthread_mutex_unlock(&cmd_queue_lock);
+    kill(-process->pid, SIGCONT);
+    if (slice_ms(process) >= 0)
+        wake_supervisor();
 }
 
 /*
- * Runs jobs on the process_buffer queue. After job is completed the job is sent to the finished_buffer queue
+ * Records a process that has exited, could not be launched or was cancelled
+ * in the metrics. Setting all the correct values as needed.
+ * usage holds what wait4 reported for the job, NULL if it never ran
+ * The process is freed, returns the jobs that were parked waiting for its cores
  */
-void *dispatcher(void *ptr)
+static process_p retire_process(process_p process, int status, struct rusage *usage)
 {
+    long long now = now_ns();
 
-    while (1)
+    pthread_mutex_lock(&running_lock);
+    if (process->running)
+        unlink_running(process);
+    pthread_mutex_unlock(&running_lock);
+
+    if (process->pid > 0)
+        process->ran_ns += now - process->slice_start;
+
+    process->cpu_remaining_burst = 0;
+
+    // jobs reaped without the supervisor, or never launched, exit as they are reaped
+    if (!process->exit_ns)
+        process->exit_ns = now;
+
+    finished_process_t record;
+    finished_process_p finished_process = &record;
+
+    //allows more accurate cpu burst, if we run ls 10 1, ls wont actually run for 10 seconds, therefore we need to update its burst time
+    //only time actually spent on the cpu counts, time stopped by round robin does not
+    process->cpu_burst = process->ran_ns / 1000;
+
+    strcpy(finished_process->cmd, process->cmd);
+    finished_process->id = process->id;
+    finished_process->arrival_time = process->arrival_time;
+    finished_process->cpu_burst = process->cpu_burst;
+    finished_process->interruptions = process->interruptions;
+    finished_process->priority = process->priority;
+    finished_process->cpus = process->placement.cpus ? process->placement.cpus : 1;
+    finished_process->exit_status = status;
+    finished_process->demotions = process->demotions;
+    finished_process->boosts = process->boosts;
+    finished_process->submit_ns = process->submit_ns;
+    finished_process->enqueue_ns = process->enqueue_ns;
+    finished_process->dispatch_ns = process->dispatch_ns;
+    finished_process->exec_ns = process->exec_ns;
+    finished_process->exit_ns = process->exit_ns;
+    finished_process->reaped_ns = now;
+
+    // what the job really used, a job that mostly sleeps holds a slot but little cpu
+    if (usage)
+    {
+        finished_process->user_time = usage->ru_utime.tv_sec * 1000000LL + usage->ru_utime.tv_usec;
+        finished_process->system_time = usage->ru_stime.tv_sec * 1000000LL + usage->ru_stime.tv_usec;
+        finished_process->max_rss = usage->ru_maxrss;
+        finished_process->minor_faults = usage->ru_minflt;
+        finished_process->major_faults = usage->ru_majflt;
+        finished_process->voluntary_switches = usage->ru_nvcsw;
+        finished_process->involuntary_switches = usage->ru_nivcsw;
+    }
+    else
     {
+        finished_process->user_time = 0;
+        finished_process->system_time = 0;
+        finished_process->max_rss = 0;
+        finished_process->minor_faults = 0;
+        finished_process->major_faults = 0;
+        finished_process->voluntary_switches = 0;
+        finished_process->involuntary_switches = 0;
+    }
 
-        /* lock and unlock for the shared process queue */
-        pthread_mutex_lock(&cmd_queue_lock);
+    finished_process->turnaround_time = (process->exit_ns - process->submit_ns) / 1000;
+    finished_process->waiting_time = finished_process->turnaround_time - finished_process->cpu_burst;
+    if (finished_process->waiting_time < 0)
+        finished_process->waiting_time = 0;
+    finished_process->response_time = (process->exec_ns - process->submit_ns) / 1000;
 
-        // printf("In dispatcher: count = %d\n", count);
+    // a job cancelled before it was launched has no times, it only counts as failed
+    if (!process->exec_ns)
+    {
+        finished_process->turnaround_time = 0;
+        finished_process->waiting_time = 0;
+        finished_process->response_time = 0;
+    }
 
-        while (count == 0)
-        {
-            pthread_cond_wait(&cmd_buf_not_empty, &cmd_queue_lock);
-        }
-        running_process = process_buffer[buf_tail];
+    // only the aggregates and a few recent jobs are kept in memory
+    record_finished(finished_process);
+    telemetry_finish(process, status);
 
-        pthread_cond_signal(&cmd_buf_not_full);
-        /* Unlock the shared command queue */
-        pthread_mutex_unlock(&cmd_queue_lock);
+    process_p parked = process->claim ? release_cpus(process) : NULL;
+    free(process->after);
+    free(process);
+    // the status is set first, a job submitted --after this one either sees it or is journaled before the finish
+    notify_completion(finished_process->id, status);
+    journal_finish(finished_process->id, status);
+    return parked;
+}
 
-        complete_process(running_process);
-        /* Run the command scheduled in the queue */
-        count--;
+/*
+ * Finishes a process that has exited or could not be launched. Its job slot
+ * is handed back to the dispatchers and the jobs waiting on it are queued, or
+ * cancelled if it failed
+ */
+void finish_process(process_p process, int status, struct rusage *usage)
+{
+    u_int id = process->id;
+    process_p parked = retire_process(process, status, usage);
+    free_slots++;
+    wake_idle_worker(0);
+
+    // jobs waiting for cores try again now some are free
+    requeue_processes(parked);
+
+    process_p ready = NULL;
+    process_p cancelled = NULL;
+    release_dependents(id, status, &ready, &cancelled);
+    settle_dependents(ready, cancelled);
+}
 
-        // printf("In dispatcher: process_buffer[%d] = %s\n", buf_tail, process_buffer[buf_tail]->cmd);
+/*
+ * Queues the held jobs in ready and cancels the ones in cancelled. Cancelling
+ * a job releases the jobs waiting on it in turn, so everything below a failed
+ * job is cancelled without recursing however deep the chain is
+ */
+static void settle_dependents(process_p ready, process_p cancelled)
+{
+    while (cancelled)
+    {
+        process_p process = cancelled;
+        u_int id = process->id;
+        cancelled = process->next;
 
-        /* Move buf_tail forward, this is a circular queue */
-        buf_tail++;
-        buf_tail %= CMD_BUF_SIZE;
+        telemetry_cancel(process);
+        retire_process(process, JOB_CANCELLED, NULL);
+        release_dependents(id, JOB_CANCELLED, &ready, &cancelled);
+    }
 
-        running_process = NULL;
+    while (ready)
+    {
+        process_p process = ready;
+        ready = process->next;
+        telemetry_release(process);
+        push_process(process);
     }
-    return (void *)NULL;
 }
 
 /*
- * Calculates the estimated wait time for the newly added process 
- * to be loaded onto the CPU
+ * Allocates the status window on first use, callers hold completion_lock
  */
-int calculate_wait()
+static void init_status()
 {
-    int wait = 0;
-    int i;
-    for (i = buf_tail; i < buf_head; i++)
+    if (job_status)
+        return;
+    job_status = malloc(JOB_STATUS_WINDOW * sizeof(short));
+    if (job_status == NULL)
     {
-        wait += process_buffer[i]->cpu_remaining_burst;
+        perror("Unable to malloc job status window");
+        exit(1);
+    }
+    u_int i;
+    for (i = 0; i < JOB_STATUS_WINDOW; i++)
+    {
+        job_status[i] = JOB_PENDING;
     }
-    return wait;
 }
 
 /*
- * Loads process via argv, this is called when `run` is specified in the command line
+ * Remembers that job id is unfinished though the window has passed it,
+ * callers hold completion_lock. Ids are added in increasing order
  */
-process_p get_process(char **argv)
+static void add_straggler(u_int id)
 {
-    process_p process = malloc(sizeof(process_t));
-    remove_newline(argv[3]);
+    if (num_stragglers == stragglers_size)
+    {
+        stragglers_size = stragglers_size ? stragglers_size * 2 : 64;
+        stragglers = realloc(stragglers, stragglers_size * sizeof(struct straggler));
+        if (stragglers == NULL)
+        {
+            perror("Unable to grow straggler table");
+            exit(1);
+        }
+    }
+    stragglers[num_stragglers].id = id;
+    stragglers[num_stragglers].status = JOB_PENDING;
+    stragglers[num_stragglers].aged = 0;
+    num_stragglers++;
+}
 
-    // load process structure
-    strcpy(process->cmd, argv[1]);
-    process->arrival_time = time(NULL);
-    process->cpu_burst = atoi(argv[2]);
-    process->cpu_remaining_burst = process->cpu_burst;
-    process->priority = atoi(argv[3]);
-    process->interruptions = 0;
-    process->first_time_on_cpu = 0;
-    return process;
+/*
+ * Returns the straggler for job id, NULL if it is not one. Callers hold completion_lock
+ */
+static struct straggler *find_straggler(u_int id)
+{
+    u_int low = 0, high = num_stragglers;
+    while (low < high)
+    {
+        u_int middle = low + (high - low) / 2;
+        if (stragglers[middle].id < id)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < num_stragglers && stragglers[low].id == id ? &stragglers[low] : NULL;
 }
 
 /*
- * Finishes a process. Runs the process using system and loads it into the
- * finished_process buffer. Setting all the correct values as needed.
+ * Moves the window up to start at base, callers hold completion_lock. Jobs it
+ * passes that are still unfinished become stragglers, the others' exit
+ * status is forgotten. A straggler is forgotten on the second move after it
+ * finished, so a waiter woken by its completion still finds its status
  */
-void complete_process(process_p process)
+static void slide_status(u_int base)
 {
-    char cmd[MAX_CMD_LEN * 2];
-    if (!strcmp(process->cmd, "./microbatch.out"))
-        sprintf(cmd, "%s %d", process->cmd, process->cpu_remaining_burst);
-    else
-        sprintf(cmd, "%s > /dev/null", process->cmd);
+    u_int i, kept = 0;
+    for (i = 0; i < num_stragglers; i++)
+    {
+        if (stragglers[i].status != JOB_PENDING && stragglers[i].aged)
+            continue;
+        if (stragglers[i].status != JOB_PENDING)
+            stragglers[i].aged = 1;
+        stragglers[kept++] = stragglers[i];
+    }
+    num_stragglers = kept;
 
-    if (process->first_time_on_cpu == 0)
-        process->first_time_on_cpu = time(NULL);
+    u_int id;
+    for (id = status_base; id < base; id++)
+    {
+        // ids past the old window had nothing finish yet
+        if (id - status_base >= JOB_STATUS_WINDOW)
+            add_straggler(id);
+        else
+        {
+            if (job_status[id % JOB_STATUS_WINDOW] == JOB_PENDING)
+                add_straggler(id);
+            job_status[id % JOB_STATUS_WINDOW] = JOB_PENDING;
+        }
+    }
+    status_base = base;
+}
 
-    system(cmd);
+/*
+ * Records the exit status of job id, callers hold completion_lock
+ */
+static void store_status(u_int id, int status)
+{
+    init_status();
+    if (id < status_base)
+    {
+        struct straggler *straggler = find_straggler(id);
+        if (straggler)
+            straggler->status = status;
+        return;
+    }
+    if (id - status_base >= JOB_STATUS_WINDOW)
+        slide_status(id - JOB_STATUS_WINDOW + 1);
+    job_status[id % JOB_STATUS_WINDOW] = status;
+}
 
-    process->cpu_remaining_burst = 0;
+/*
+ * Returns the exit status of job id, JOB_PENDING if it has not finished and
+ * JOB_UNKNOWN if it finished too long ago. Callers hold completion_lock
+ */
+static int load_status(u_int id)
+{
+    if (id >= status_base)
+    {
+        if (!job_status || id - status_base >= JOB_STATUS_WINDOW)
+            return JOB_PENDING;
+        return job_status[id % JOB_STATUS_WINDOW];
+    }
+    struct straggler *straggler = find_straggler(id);
+    return straggler ? straggler->status : JOB_UNKNOWN;
+}
 
-    finished_process_p finished_process = malloc(sizeof(finished_process_t));
-    finished_process->finish_time = time(NULL);
+/*
+ * Records that job id finished with status and wakes everyone waiting on a
+ * completion. count goes down under the lock so a waiter can never check it
+ * and then miss the wakeup
+ */
+static void notify_completion(u_int id, int status)
+{
+    pthread_mutex_lock(&completion_lock);
+    store_status(id, status);
+    completions++;
+    count--;
+    pthread_cond_broadcast(&completion);
+    if (completion_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(completion_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+            perror("Unable to signal completion");
+    }
+    pthread_mutex_unlock(&completion_lock);
+}
 
-    //allows more accurate cpu burst, if we run ls 10 1, ls wont actually run for 10 seconds, therefore we need to update its burst time
-    process->cpu_burst = (int)(finished_process->finish_time - process->first_time_on_cpu);
+/*
+ * Rebuilds the exit status window after the journal recovered the jobs in
+ * pending. Every other id below next_id finished before aubatch stopped and
+ * its exit status was not kept, the window starts at next_id and the
+ * recovered jobs are stragglers
+ */
+void restore_job_status(process_p *pending, int n)
+{
+    pthread_mutex_lock(&completion_lock);
+    init_status();
+    u_int i;
+    for (i = 0; i < JOB_STATUS_WINDOW; i++)
+    {
+        job_status[i] = JOB_PENDING;
+    }
+    status_base = next_id;
 
-    strcpy(finished_process->cmd, process->cmd);
-    finished_process->arrival_time = process->arrival_time;
-    finished_process->cpu_burst = process->cpu_burst;
-    finished_process->interruptions = process->interruptions;
-    finished_process->priority = process->priority;
-    finished_process->first_time_on_cpu = process->first_time_on_cpu;
-    finished_process->turnaround_time = finished_process->finish_time - finished_process->arrival_time;
-    if (finished_process->turnaround_time)
-        finished_process->waiting_time = finished_process->turnaround_time - finished_process->cpu_burst;
-    else
-        finished_process->waiting_time = 0;
+    // pending is sorted by id, as the stragglers have to be
+    num_stragglers = 0;
+    for (i = 0; i < n; i++)
+    {
+        add_straggler(pending[i]->id);
+    }
+    pthread_mutex_unlock(&completion_lock);
+}
 
-    finished_process->response_time = finished_process->first_time_on_cpu - finished_process->arrival_time;
+/*
+ * Returns an eventfd that becomes readable whenever a job finishes, for
+ * threads that wait on completions from an event loop instead of blocking
+ */
+int completion_eventfd()
+{
+    pthread_mutex_lock(&completion_lock);
+    if (completion_fd < 0)
+        completion_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    int fd = completion_fd;
+    pthread_mutex_unlock(&completion_lock);
+    return fd;
+}
 
-    finished_process_buffer[finished_head] = finished_process;
-    finished_head++;
+/*
+ * Checks on job id without blocking. Returns 1 and sets status if it has
+ * finished, 0 if it has not and -1 if no job with that id was submitted
+ */
+int poll_job(u_int id, int *status)
+{
+    if (id >= next_id)
+        return -1;
+
+    pthread_mutex_lock(&completion_lock);
+    int current = load_status(id);
+    int finished = current != JOB_PENDING;
+    if (finished)
+        *status = current;
+    pthread_mutex_unlock(&completion_lock);
+    return finished;
+}
 
-    free(process);
+/*
+ * Blocks until every submitted job has finished
+ */
+void wait_for_idle()
+{
+    pthread_mutex_lock(&completion_lock);
+    while (count)
+    {
+        pthread_cond_wait(&completion, &completion_lock);
+    }
+    pthread_mutex_unlock(&completion_lock);
 }
 
 /*
- * Reports job / process metrics. If no jobs are completed then notify user and return
- * 
- * Else dump all metrics per job and overall metrics
+ * Blocks until one more job finishes, returns straight away if there are no
+ * unfinished jobs to wait for
  */
-void report_metrics()
+void wait_for_next_completion()
 {
-    if (!finished_head)
+    pthread_mutex_lock(&completion_lock);
+    unsigned long long seen = completions;
+    while (count && completions == seen)
     {
-        printf("No jobs completed!\n");
-        return;
+        pthread_cond_wait(&completion, &completion_lock);
+    }
+    pthread_mutex_unlock(&completion_lock);
+}
+
+/*
+ * Blocks until job id finishes and returns its exit status, -1 if no job
+ * with that id was ever submitted. Jobs that already finished return at once
+ */
+int wait_for_job(u_int id)
+{
+    if (id >= next_id)
+        return -1;
+
+    pthread_mutex_lock(&completion_lock);
+    int status;
+    while ((status = load_status(id)) == JOB_PENDING)
+    {
+        pthread_cond_wait(&completion, &completion_lock);
     }
-    int total_waiting_time = 0;
-    int total_turnaround_time = 0;
-    int total_response_time = 0;
-    int total_cpu_burst = 0;
-
-    int max_waiting_time = INT_MIN;
-    int min_waiting_time = INT_MAX;
-    int max_response_time = INT_MIN;
-    int min_response_time = INT_MAX;
-    int max_turnaround_time = INT_MIN;
-    int min_turnaround_time = INT_MAX;
-    int max_cpu_burst = INT_MIN;
-    int min_cpu_burst = INT_MAX;
-
-    printf("\n=== Reporting Metrics for %s ===\n\n", get_policy_string());
-    finished_process_p finished_process;
-    int i = 0;
-    for (; i < finished_head; i++)
-    {
-        finished_process = finished_process_buffer[i];
-
-        printf("Metrics for job %s:\n", finished_process->cmd);
-        printf("\tCPU Burst:           %d seconds\n", finished_process->cpu_burst);
-        printf("\tInterruptions:       %d times\n", finished_process->interruptions);
-        printf("\tPriority:            %d\n", finished_process->priority);
-
-        printf("\tArrival Time:        %s", convert_time(finished_process->arrival_time));
-        printf("\tFirst Time on CPU:   %s", convert_time(finished_process->first_time_on_cpu));
-        printf("\tFinish Time:         %s", convert_time(finished_process->finish_time));
-
-        printf("\tTurnaround Time:     %d seconds\n", finished_process->turnaround_time);
-        printf("\tWaiting Time:        %d seconds\n", finished_process->waiting_time);
-        printf("\tResponse Time:       %d seconds\n", finished_process->response_time);
-        printf("\n");
-
-        if (finished_process->waiting_time < min_waiting_time)
-            min_waiting_time = finished_process->waiting_time;
-        if (finished_process->turnaround_time < min_turnaround_time)
-            min_turnaround_time = finished_process->turnaround_time;
-        if (finished_process->response_time < min_response_time)
-            min_response_time = finished_process->response_time;
-        if (finished_process->cpu_burst < min_cpu_burst)
-            min_cpu_burst = finished_process->cpu_burst;
-
-        if (finished_process->waiting_time > max_waiting_time)
-            max_waiting_time = finished_process->waiting_time;
-        if (finished_process->turnaround_time > max_response_time)
-            max_turnaround_time = finished_process->turnaround_time;
-        if (finished_process->response_time > max_response_time)
-            max_response_time = finished_process->response_time;
-        if (finished_process->cpu_burst > max_cpu_burst)
-            max_cpu_burst = finished_process->cpu_burst;
-
-        total_response_time += finished_process->response_time;
-        total_waiting_time += finished_process->waiting_time;
-        total_turnaround_time += finished_process->turnaround_time;
-        total_cpu_burst += finished_process->cpu_burst;
-    }
-
-    printf("Overall Metrics for Batch:\n");
-    printf("\tTotal Number of Jobs Completed: %d\n", finished_head);
-    printf("\tTotal Number of Jobs Submitted: %d\n", finished_head + (buf_head - buf_tail));
-    printf("\tAverage Turnaround Time:        %.3f seconds\n", total_turnaround_time / (float)i);
-    printf("\tAverage Waiting Time:           %.3f seconds\n", total_waiting_time / (float)i);
-    printf("\tAverage Response Time:          %.3f seconds\n", total_response_time / (float)i);
-    printf("\tAverage CPU Burst:              %.3f seconds\n", total_cpu_burst / (float)i);
-    printf("\tTotal CPU Burst:                %d seconds\n", total_cpu_burst);
-    printf("\tThroughput:                     %.3f No./second\n", 1 / (total_turnaround_time / (float)i));
-
-    printf("\tMax Turnaround Time:            %d seconds\n", max_turnaround_time);
-    printf("\tMin Turnaround Time:            %d seconds\n\n", min_turnaround_time);
-
-    printf("\tMax Waiting Time:               %d seconds\n", max_waiting_time);
-    printf("\tMin Waiting Time:               %d seconds\n\n", min_waiting_time);
-
-    printf("\tMax Response Time:              %d seconds\n", max_response_time);
-    printf("\tMin Response Time:              %d seconds\n\n", min_response_time);
-
-    printf("\tMax CPU Burst:                  %d seconds\n", max_cpu_burst);
-    printf("\tMin CPU Burst:                  %d seconds\n\n", min_cpu_burst);
-}
-
-/*
- * Sorts buffer per scheduling policy
- */
-void sort_buffer(process_p *process_buffer)
-{
-    void *sort;
+    pthread_mutex_unlock(&completion_lock);
+    return status;
+}
+
+/*
+ * Returns the comparator the ready queue should use for the current scheduling policy
+ */
+compare_t get_policy_compare()
+{
     switch (policy)
     {
-    case FCFS:
-        sort = fcfs_scheduler;
-        break;
     case SJF:
-        sort = sjf_scheduler;
-        break;
+    case SRTF:
+        return sjf_scheduler;
     case PRIORITY:
-        sort = priority_scheduler;
+        return priority_scheduler;
+    case RR:
+        return rr_scheduler;
+    case MLFQ:
+        return mlfq_scheduler;
+    case FCFS:
+    case BACKFILL:
+    default:
+        return fcfs_scheduler;
     }
-
-    // only sort buf_tail and more, if we sort at the base of process_buffer we will
-    // sort processes that are currently running on the cpu
-    int index;
-
-    // if we are doing a batch job, aka arrival rate is not 0 then add 1 to buf_tail
-    // if we sort ahead of buf_tail for a batch job we will all the processes even tho
-    // none are currently on the cpu
-    if (!batch)
-        index = buf_tail + 1;
-    else
-        index = buf_tail;
-    qsort(&process_buffer[index], buf_head - index, sizeof(process_p), sort);
 }
 
 /*
@@ -378,7 +1626,9 @@ int sjf_scheduler(const void *a, const void *b)
     process_p process_a = *(process_p *)a;
     process_p process_b = *(process_p *)b;
 
-    return (process_a->cpu_remaining_burst - process_b->cpu_remaining_burst);
+    if (process_a->cpu_remaining_burst != process_b->cpu_remaining_burst)
+        return (process_a->cpu_remaining_burst < process_b->cpu_remaining_burst) ? -1 : 1;
+    return fcfs_scheduler(a, b);
 }
 
 /*
@@ -390,7 +1640,10 @@ int fcfs_scheduler(const void *a, const void *b)
     process_p process_a = *(process_p *)a;
     process_p process_b = *(process_p *)b;
 
-    return (process_a->arrival_time - process_b->arrival_time);
+    if (process_a->submit_ns != process_b->submit_ns)
+        return (process_a->submit_ns < process_b->submit_ns) ? -1 : 1;
+    // jobs submitted at the same instant run in submission order
+    return (process_a->id < process_b->id) ? -1 : (process_a->id > process_b->id);
 }
 
 /*
@@ -402,7 +1655,45 @@ int priority_scheduler(const void *a, const void *b)
     process_p process_a = *(process_p *)a;
     process_p process_b = *(process_p *)b;
 
-    return (-process_a->priority + process_b->priority);
+    if (process_a->priority != process_b->priority)
+        return (-process_a->priority + process_b->priority);
+    return fcfs_scheduler(a, b);
+}
+
+/*
+ * Returns the number of feedback levels the run queues need, 0 unless the policy is mlfq
+ */
+u_int get_policy_levels()
+{
+    return policy == MLFQ ? mlfq_levels : 0;
+}
+
+/*
+ * Multi-level feedback queue sorting algorithm used by qsort, higher levels
+ * run first and each level is round robin
+ */
+int mlfq_scheduler(const void *a, const void *b)
+{
+
+    process_p process_a = *(process_p *)a;
+    process_p process_b = *(process_p *)b;
+
+    if (process_a->level != process_b->level)
+        return (process_a->level < process_b->level) ? -1 : 1;
+    return rr_scheduler(a, b);
+}
+
+/*
+ * Round Robin sorting algorithm used by qsort, processes run in the order
+ * they joined the run queues so a preempted process goes to the back
+ */
+int rr_scheduler(const void *a, const void *b)
+{
+
+    process_p process_a = *(process_p *)a;
+    process_p process_b = *(process_p *)b;
+
+    return (process_a->queued < process_b->queued) ? -1 : (process_a->queued > process_b->queued);
 }
 
 /*
@@ -443,6 +1734,18 @@ char *get_policy_string()
     case PRIORITY:
         return "Priority";
 
+    case RR:
+        return "RR";
+
+    case SRTF:
+        return "SRTF";
+
+    case MLFQ:
+        return "MLFQ";
+
+    case BACKFILL:
+        return "EASY Backfill";
+
     default:
         return "Unknown";
     }
@@ -451,12 +1754,16 @@ char *get_policy_string()
 /*
  * After a job is submitted print information about the current queue
  */
-void submit_job(const char *cmd)
+void submit_job(process_p process)
 {
     const char *str_policy = get_policy_string();
-    printf("Job %s was submitted.\n", cmd);
+    printf("Job %s was submitted as job %u.\n", process->cmd, process->id);
     printf("Total number of jobs in the queue: %d\n", count + 1);
-    printf("Expected waiting time: %d\n",
-           calculate_wait());
+    // a held job waits on jobs that may not have started yet
+    if (process->num_after)
+        printf("Expected waiting time: unknown, it waits on %d jobs\n", process->num_after);
+    else
+        printf("Expected waiting time: %.3f seconds\n",
+               calculate_wait() / 1000000.0);
     printf("Scheduling Policy: %s.\n", str_policy);
 }
\ No newline at end of file
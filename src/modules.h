@@ -1,45 +1,117 @@
+#ifndef MODULES_H
+#define MODULES_H
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <limits.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#include "queue.h"
+#include "channel.h"
+#include "workload.h"
 
-#define CMD_BUF_SIZE 10 /* The size of the command queue */
 #define MAX_CMD_LEN 512 /* The longest scheduler length */
+#define DEFAULT_QUANTUM_MS 1000 /* round robin time slice until rr <quantum_ms> is used */
+#define DEFAULT_BOOST_MS 5000   /* how often mlfq moves every job back to the top level */
+#define MLFQ_MAX_LEVELS 8       /* most feedback levels mlfq can be configured with */
+#define JOB_PENDING -1            /* exit status of a job that has not finished */
+#define JOB_UNKNOWN -2            /* exit status of a job that finished before a restart or too long ago */
+#define JOB_CANCELLED 125         /* exit status of a job cancelled as a job it ran --after failed */
+#define SUBMIT_CHANNEL_SIZE 4096 /* submissions that can wait for the scheduler stage */
+#define JOB_STATUS_WINDOW (1 << 16) /* most recent job ids whose exit status is kept */
 
 enum scheduling_policies
 {
     FCFS,
     SJF,
     PRIORITY,
-} policy;
+    RR,
+    SRTF,
+    MLFQ,
+    BACKFILL, /* fcfs order, later jobs start early on free cores if that does not delay the first waiting job */
+};
+
+typedef struct
+{
+    int cpus; /* cores the job asked for, 0 to float over every core */
+    int numa; /* one of numa_modes in placement.h, how the cores and memory are placed */
+    int node; /* numa node for NUMA_NODE */
+
+} placement_t;
 
 typedef struct
+{
+    u_int id; /* job waited on */
+    int ok;   /* 1 if it has to succeed (--after), 0 if it only has to finish (--afterany) */
+
+} dependency_t;
+
+typedef struct process
 {
     char cmd[MAX_CMD_LEN];
-    time_t arrival_time;
-    int cpu_burst;
-    int cpu_remaining_burst;
+    u_int id;     /* submission order, breaks ties between otherwise equal processes */
+    u_int queued; /* order the process last joined a run queue, used by round robin */
+    time_t arrival_time;          /* wall clock submission time, only used for display */
+    long long cpu_burst;          /* requested cpu time in microseconds */
+    long long cpu_remaining_burst; /* requested cpu time not yet used in microseconds */
     int priority;
     int interruptions;
-    int first_time_on_cpu;
+    long long submit_ns;          /* now_ns() when the job was submitted */
+    long long enqueue_ns;         /* now_ns() when the job first joined a run queue */
+    long long dispatch_ns;        /* now_ns() when a worker first took the job off a run queue */
+    long long exec_ns;            /* now_ns() when the job was launched, 0 until then */
+    long long exit_ns;            /* now_ns() when the job's exit was noticed, 0 until then */
+    pid_t pid;                    /* pid of the launched job, 0 until it is launched */
+    int pidfd;                    /* pidfd the supervisor watches for the job's exit */
+    int running;                  /* on running_list, as opposed to waiting or stopped */
+    u_int level;                  /* mlfq feedback level, 0 is the top */
+    int demotions;                /* times mlfq moved the process down a level */
+    int boosts;                   /* times an mlfq boost moved the process back to the top */
+    struct process *qnext;        /* link in an mlfq level fifo */
+    long long slice_start;        /* now_ns() when the process was last put on the cpu */
+    long long ran_ns;             /* time spent on the cpu over all finished slices */
+    struct process *prev, *next; /* links in running_list, or among the jobs parked waiting for cores */
+    placement_t placement;        /* cores and numa nodes the job asked for */
+    struct claim *claim;          /* cores the job holds from launch to exit, NULL if none */
+    dependency_t *after;          /* jobs it waits on before it is queued, NULL if none */
+    int num_after;
 
 } process_t;
 
 typedef struct
 {
     char cmd[MAX_CMD_LEN];
-    time_t arrival_time;
-    int cpu_burst;
-    int first_time_on_cpu;
+    u_int id;
+    time_t arrival_time;   /* wall clock submission time, only used for display */
+    long long cpu_burst;   /* cpu time actually used in microseconds */
     int priority;
     int interruptions;
-    int finish_time;
-    int turnaround_time;
-    int waiting_time;
-    int response_time;
+    long long submit_ns;   /* lifecycle stamps from the monotonic clock, see process_t */
+    long long enqueue_ns;
+    long long dispatch_ns;
+    long long exec_ns;
+    long long exit_ns;
+    long long reaped_ns;   /* now_ns() when the job was reaped and finished */
+    long long turnaround_time; /* submit to exit in microseconds */
+    long long waiting_time;    /* turnaround less cpu time in microseconds */
+    long long response_time;   /* submit to launch in microseconds */
+    int exit_status; /* shell style exit status, 128 + signal if killed */
+    int demotions;   /* mlfq level changes down */
+    int boosts;      /* mlfq level changes back to the top */
+    long long user_time;        /* user cpu time from wait4 in microseconds */
+    long long system_time;      /* system cpu time from wait4 in microseconds */
+    long max_rss;               /* peak resident set size in kilobytes */
+    long minor_faults;          /* page faults served without io */
+    long major_faults;          /* page faults that needed io */
+    long voluntary_switches;    /* context switches from blocking */
+    long involuntary_switches;  /* context switches from preemption by the kernel */
+    int cpus;                   /* cores the job held, 1 if it floated */
 
 } finished_process_t;
 
@@ -48,42 +120,87 @@ typedef process_t *process_p;
 typedef finished_process_t *finished_process_p;
 typedef unsigned int u_int;
 
+typedef struct
+{
+    pthread_mutex_t lock;   /* guards queue and pending */
+    pthread_cond_t wakeup;  /* signalled when work and a job slot may be available for this worker */
+    ready_queue_t queue;    /* processes waiting on this worker */
+    int pending;            /* a wakeup was posted and not yet consumed */
+    u_int neighbour;        /* last queue checked for a better head, see take_local */
+    atomic_uint depth;      /* queue.size, readable without the lock */
+    atomic_llong queued_burst; /* cpu_remaining_burst over the queue in microseconds, readable without the lock */
+    atomic_int idle;        /* worker found no work and is about to sleep */
+
+} worker_t;
+
 // Scheduler and dispatch prototypes
-void test_scheduler(char *benchmark, int num_of_jobs, int arrival_rate, int priority_levels, int min_CPU_time, int max_CPU_time); /* To simulate batch job submission and scheduling */
-void scheduler(int argc, char **argv);                                                                                            /* To simulate job submissions and scheduling */
-void *dispatcher(void *ptr);                                                                                                      /* To simulate job execution */
+void test_scheduler(workload_t *workload, int num_of_jobs);                                                                       /* To simulate batch job submission and scheduling */
+process_p new_test_process(workload_t *workload);                                                                                 /* builds the next benchmark job, shared by test and simulate */
+void scheduler(int argc, char **argv, placement_t *placement, dependency_t *after, int num_after);                                                   /* To simulate job submissions and scheduling */
+void *dispatcher(void *ptr);                                                                                                      /* To simulate job execution, ptr is the worker index */
+void *supervisor(void *ptr);                                                                                                      /* reaps running jobs as they exit */
+void *scheduler_stage(void *ptr);                                                                                                 /* moves submissions from the channel onto the run queues */
+void enqueue_process(process_p process);                                                                                          /* pushes a new process onto the submission channel */
+void enqueue_batch(process_p *processes, int n);                                                                                  /* pushes a batch of processes onto the submission channel */
+void requeue_processes(process_p processes);                                                                                      /* queues again jobs linked through next, such as parked ones */
+
+// worker prototypes
+void init_workers();        /* sets up num_workers run queues and the submission channel */
+void init_supervisor();     /* sets up the supervisor and num_slots job slots */
+void wake_supervisor();     /* makes the supervisor recheck its time slices */
+void lock_all_workers();    /* locks every run queue in index order */
+void unlock_all_workers();  /* releases every run queue */
+u_int get_default_workers(); /* number of online cpus, at least one */
+
+// completion prototypes
+void wait_for_idle();            /* blocks until every submitted job has finished */
+void wait_for_next_completion(); /* blocks until one more job finishes, at once if none are unfinished */
+int wait_for_job(u_int id);      /* blocks until job id finishes, returns its exit status or -1 if there is no such job */
+int poll_job(u_int id, int *status); /* 1 and the exit status if job id finished, 0 if not, -1 if there is no such job */
+int completion_eventfd();        /* eventfd that becomes readable when a job finishes */
+void restore_job_status(process_p *pending, int n); /* after recovery, every id below next_id but those in pending has finished */
 
 // sorting prototypes
-void sort_buffer(process_p *process_buffer);          /* sorts process buffer depending on scheduler */
+compare_t get_policy_compare();                       /* returns the comparator for the current scheduler */
+u_int get_policy_levels();                            /* returns the number of feedback levels for the current scheduler */
 int sjf_scheduler(const void *a, const void *b);      /* sorts buffer by remaining cpu burst */
 int fcfs_scheduler(const void *a, const void *b);     /* sorts buffer by arrival time */
 int priority_scheduler(const void *a, const void *b); /* sorts buffer by priority */
+int rr_scheduler(const void *a, const void *b);       /* sorts buffer by time joined the run queue */
+int mlfq_scheduler(const void *a, const void *b);     /* sorts buffer by feedback level then time joined */
 
 // process functions
 process_p get_process(char **argv);       /* returns new process_p based on input args */
+process_p new_process(const char *cmd, long long cpu_burst, int priority); /* returns a new process submitted now, cpu_burst in microseconds */
 int run_process(int burst);               /* sleeps for burst seconds */
-void complete_process(process_p process); /* copys process to completed process buffer */
-void submit_job(const char *cmd);         /* submits job to be ran */
-
-void report_metrics(); /* loops through completed process buffer and prints metrics */
+void start_process(process_p process);             /* launches process and hands it to the supervisor */
+void resume_process(process_p process);            /* continues a preempted process */
+void finish_process(process_p process, int status, struct rusage *usage); /* records process in the metrics, usage may be NULL */
+void submit_job(process_p process);       /* prints information about a newly submitted job */
 
 // utility functions
 char *convert_time(time_t time);   /* convers from epoch time to human readable string */
 void remove_newline(char *buffer); /* pulls newline off of string read from user input*/
 char *get_policy_string();         /* returns a human readable string of the current scheduling policy */
-int calculate_wait();              /* calculate wait time for the process that was just added */
+long long calculate_wait();         /* expected wait in microseconds for a process about to be queued */
+long long now_ns();                /* monotonic clock in nanoseconds */
 
 /* Global shared variables */
-u_int buf_head;      /* points to the next free slot in process_buffer */
-u_int buf_tail;      /* points to the next process to be loaded onto the cpu */
-u_int count;         /* the number of waiting processes */
-u_int finished_head; /* points to the next free slot in the finished process buffer */
-u_int batch;
-
-process_p running_process;                        /* running process */
-process_p process_buffer[CMD_BUF_SIZE];           /* buffer of waiting processes */
-finished_process_p finished_process_buffer[8192]; /* buffer of finished processes*/
-
-pthread_mutex_t cmd_queue_lock;   /* Lock for critical sections */
-pthread_cond_t cmd_buf_not_full;  /* Condition variable for buf_not_full */
-pthread_cond_t cmd_buf_not_empty; /* Condition variable for buf_not_empty */
+extern enum scheduling_policies policy; /* current scheduling policy */
+extern atomic_uint count;               /* the number of submitted processes that have not finished */
+extern atomic_uint next_id;             /* id handed to the next submitted process */
+extern u_int num_workers;               /* number of dispatcher workers */
+extern u_int num_slots;                 /* most jobs allowed to run at once */
+extern atomic_uint free_slots;          /* job slots not in use */
+extern u_int quantum_ms;                /* round robin time slice */
+extern u_int mlfq_quanta[MLFQ_MAX_LEVELS]; /* time slice of each mlfq level */
+extern u_int mlfq_levels;               /* number of mlfq levels in use */
+extern u_int boost_ms;                  /* mlfq boost period */
+
+extern worker_t *workers;                                /* dispatcher workers, each with its own run queue */
+extern process_p running_list;                           /* launched processes that have not exited */
+
+extern pthread_mutex_t finished_lock; /* Lock for the metrics of finished processes */
+extern pthread_mutex_t running_lock;  /* Lock for the running list */
+
+#endif
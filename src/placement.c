@@ -0,0 +1,648 @@
+/*
+ * COMP7500/7506
+ * Project 3: placement
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Pins jobs that ask for it (run --cpus <n> [--numa <placement>]) to their
+ * own cores and numa nodes. The free cores of every node are tracked here, a
+ * dispatcher claims a job's cores before launching it and they are released
+ * when the job exits. A job whose cores are not free yet is parked and
+ * queued again once some are released, its job slot goes to other jobs in
+ * the meantime. A preempted job keeps its cores so it resumes where its
+ * cache is
+ *
+ * The first job in policy order whose cores are not free holds a
+ * reservation and later jobs asking for cores wait behind it, so a wide job
+ * is not starved by a stream of narrow ones. Under the backfill policy every
+ * job is charged cores, at least one, and the reserved job gets a start time
+ * from the declared bursts of the running jobs (EASY backfilling). Later
+ * jobs jump ahead of it only if they cannot delay that start
+ *
+ * posix_spawn has no affinity attribute, but a child inherits the cpu
+ * affinity and the memory policy of the thread that spawns it. The
+ * dispatcher takes on the job's cores and memory policy for the length of
+ * the spawn, so the job is placed before it execs and so is anything it
+ * forks
+ *
+ */
+
+#define _GNU_SOURCE /* cpu_set_t, pthread_setaffinity_np */
+
+#include "placement.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+typedef struct
+{
+    cpu_set_t cpus; /* cores of this node aubatch may use */
+    cpu_set_t free; /* those not claimed by a job */
+    int num_cpus;   /* cores in cpus */
+    int num_free;   /* cores in free */
+
+} node_t;
+
+struct claim
+{
+    cpu_set_t cpus;      /* cores the job holds */
+    unsigned long nodes; /* nodes those cores are on, one bit each */
+    int mode;            /* memory policy the job runs under, MPOL_DEFAULT to leave it alone */
+    int width;           /* cores charged to the job, 1 for a job that floats */
+    long long end_ns;    /* now_ns() the job should exit by, from its declared cpu burst */
+    struct claim *prev, *next; /* links in claims */
+};
+
+static pthread_mutex_t placement_lock = PTHREAD_MUTEX_INITIALIZER; /* guards the nodes, parked and the reservation */
+static node_t nodes[MAX_NODES];
+static int num_nodes;           /* nodes up to the highest one with cores, some may have none */
+static int total_cpus;          /* cores over every node */
+static int has_numa;            /* the kernel reported numa nodes, memory policies can be set */
+static cpu_set_t allowed;       /* cores aubatch was started on, dispatchers go back to these */
+static process_p parked;        /* jobs waiting for cores, linked through next */
+static struct claim *claims;    /* every claim held by a launched job */
+static int num_claims;          /* claims in claims */
+static int free_total;          /* cores not charged to any claim */
+static _Atomic(process_p) reserved; /* first job in policy order that had to be parked, NULL if none */
+static int reserved_width;          /* cores it needs */
+
+/*
+ * Adds the cores in a cpulist such as 0-3,8-11 to set, only those in allowed
+ */
+static int parse_cpulist(const char *list, cpu_set_t *set)
+{
+    int added = 0;
+    while (*list && *list != '\n')
+    {
+        char *end;
+        long first = strtol(list, &end, 10);
+        long last = first;
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+
+        long cpu;
+        for (cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                CPU_SET(cpu, set);
+                added++;
+            }
+        }
+        if (*end != ',')
+            break;
+        list = end + 1;
+    }
+    return added;
+}
+
+/*
+ * Reads which cores are on which numa node. Without numa support in the
+ * kernel every core aubatch may use counts as one node
+ */
+void init_placement()
+{
+    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+    {
+        perror("Unable to read cpu affinity");
+        exit(1);
+    }
+
+    int node;
+    for (node = 0; node < MAX_NODES; node++)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), NODE_PATH "/node%d/cpulist", node);
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+            continue;
+
+        char list[4096];
+        if (fgets(list, sizeof(list), file))
+        {
+            nodes[node].num_cpus = parse_cpulist(list, &nodes[node].cpus);
+            total_cpus += nodes[node].num_cpus;
+            num_nodes = node + 1;
+            has_numa = 1;
+        }
+        fclose(file);
+    }
+
+    if (!total_cpus)
+    {
+        nodes[0].cpus = allowed;
+        nodes[0].num_cpus = CPU_COUNT(&allowed);
+        total_cpus = nodes[0].num_cpus;
+        num_nodes = 1;
+        has_numa = 0;
+    }
+
+    for (node = 0; node < num_nodes; node++)
+    {
+        nodes[node].free = nodes[node].cpus;
+        nodes[node].num_free = nodes[node].num_cpus;
+    }
+    free_total = total_cpus;
+}
+
+/*
+ * Strips the --cpus <n> and --numa <any|local|interleave|node> options after
+ * the command name off args. Returns NULL if they are valid for this machine,
+ * otherwise what is wrong with them
+ */
+const char *parse_placement(int *nargs, char **args, placement_t *placement)
+{
+    placement->cpus = 0;
+    placement->numa = NUMA_ANY;
+    placement->node = 0;
+
+    int used = 0;
+    while (1 + used + 1 < *nargs && !strncmp(args[1 + used], "--", 2))
+    {
+        const char *option = args[1 + used];
+        const char *value = args[2 + used];
+        if (!strcmp(option, "--cpus"))
+        {
+            placement->cpus = atoi(value);
+            if (placement->cpus <= 0)
+                return "--cpus needs a positive number of cores";
+        }
+        else if (!strcmp(option, "--numa"))
+        {
+            if (!strcmp(value, "any"))
+                placement->numa = NUMA_ANY;
+            else if (!strcmp(value, "local"))
+                placement->numa = NUMA_LOCAL;
+            else if (!strcmp(value, "interleave"))
+                placement->numa = NUMA_INTERLEAVE;
+            else if (strspn(value, "0123456789") == strlen(value) && *value)
+            {
+                placement->numa = NUMA_NODE;
+                placement->node = atoi(value);
+            }
+            else
+                return "--numa takes any, local, interleave or a node number";
+        }
+        else
+            return "unknown option, only --after, --afterany, --cpus and --numa are known";
+        used += 2;
+    }
+
+    if (used)
+    {
+        memmove(&args[1], &args[1 + used], (*nargs - 1 - used) * sizeof(char *));
+        *nargs -= used;
+    }
+    return check_placement(placement);
+}
+
+/*
+ * Returns NULL if a placement can be met on this machine, otherwise why not
+ */
+const char *check_placement(placement_t *placement)
+{
+    // cores that can never all be free at once would park the job forever
+    if (placement->numa != NUMA_ANY && !placement->cpus)
+        return "--numa needs --cpus";
+    if (placement->cpus > total_cpus)
+        return "--cpus asks for more cores than aubatch may use";
+    if (placement->numa == NUMA_NODE && (placement->node >= num_nodes || !nodes[placement->node].num_cpus))
+        return "--numa names a node without cores";
+    if (placement->numa == NUMA_NODE && placement->cpus > nodes[placement->node].num_cpus)
+        return "--cpus asks for more cores than the node has";
+    if (placement->numa == NUMA_LOCAL)
+    {
+        int i;
+        int largest = 0;
+        for (i = 0; i < num_nodes; i++)
+        {
+            if (nodes[i].num_cpus > largest)
+                largest = nodes[i].num_cpus;
+        }
+        if (placement->cpus > largest)
+            return "--cpus asks for more cores than any one node has";
+    }
+    return NULL;
+}
+
+/*
+ * Moves n free cores of node into claim, callers hold placement_lock
+ */
+static void take_cpus(struct claim *claim, int node, int n)
+{
+    int cpu;
+    for (cpu = 0; n && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &nodes[node].free))
+        {
+            CPU_CLR(cpu, &nodes[node].free);
+            CPU_SET(cpu, &claim->cpus);
+            nodes[node].num_free--;
+            n--;
+        }
+    }
+    claim->nodes |= 1UL << node;
+}
+
+/*
+ * Returns the node with the fewest free cores that still has n, so large
+ * requests later find a node with room, or -1 if none has
+ */
+static int best_fit(int n)
+{
+    int best = -1;
+    int node;
+    for (node = 0; node < num_nodes; node++)
+    {
+        if (nodes[node].num_free >= n && (best < 0 || nodes[node].num_free < nodes[best].num_free))
+            best = node;
+    }
+    return best;
+}
+
+/*
+ * Takes the cores a job asked for in the way its numa mode wants, returns 0
+ * if they are not free. A job that asked for no cores takes none, it floats
+ * and is only charged a core under backfill. Callers hold placement_lock
+ */
+static int place(struct claim *claim, process_p process)
+{
+    int cpus = process->placement.cpus;
+    int node;
+    if (!cpus)
+        return 1;
+
+    int free_cpus = 0;
+    for (node = 0; node < num_nodes; node++)
+    {
+        free_cpus += nodes[node].num_free;
+    }
+
+    switch (process->placement.numa)
+    {
+    case NUMA_NODE:
+        if (nodes[process->placement.node].num_free < cpus)
+            return 0;
+        take_cpus(claim, process->placement.node, cpus);
+        claim->mode = MPOL_BIND;
+        return 1;
+
+    case NUMA_LOCAL:
+        if ((node = best_fit(cpus)) < 0)
+            return 0;
+        take_cpus(claim, node, cpus);
+        claim->mode = MPOL_BIND;
+        return 1;
+
+    case NUMA_INTERLEAVE:
+        // one core at a time from whichever node has the most free, so the cores spread evenly
+        if (free_cpus < cpus)
+            return 0;
+        for (; cpus; cpus--)
+        {
+            int most = 0;
+            for (node = 1; node < num_nodes; node++)
+            {
+                if (nodes[node].num_free > nodes[most].num_free)
+                    most = node;
+            }
+            take_cpus(claim, most, 1);
+        }
+        claim->mode = MPOL_INTERLEAVE;
+        return 1;
+
+    default:
+        // one node if any has room, otherwise spill over as few nodes as possible
+        claim->mode = MPOL_DEFAULT;
+        if ((node = best_fit(cpus)) >= 0)
+        {
+            take_cpus(claim, node, cpus);
+            return 1;
+        }
+        if (free_cpus < cpus)
+            return 0;
+        while (cpus)
+        {
+            int most = 0;
+            for (node = 1; node < num_nodes; node++)
+            {
+                if (nodes[node].num_free > nodes[most].num_free)
+                    most = node;
+            }
+            int n = nodes[most].num_free < cpus ? nodes[most].num_free : cpus;
+            take_cpus(claim, most, n);
+            cpus -= n;
+        }
+        return 1;
+    }
+}
+
+static int compare_end(const void *a, const void *b)
+{
+    long long end_a = (*(struct claim **)a)->end_ns;
+    long long end_b = (*(struct claim **)b)->end_ns;
+    return (end_a > end_b) - (end_a < end_b);
+}
+
+/*
+ * Works out when the reserved job can start, the shadow time, from the
+ * declared bursts of the running jobs, and how many cores will be left over
+ * then. Jobs running past their burst are expected to exit now. Callers
+ * hold placement_lock
+ */
+static void find_shadow(long long now, long long *shadow, int *extra)
+{
+    int available = free_total;
+    *shadow = now;
+
+    if (available < reserved_width && num_claims)
+    {
+        struct claim **ending = malloc(num_claims * sizeof(struct claim *));
+        if (ending == NULL)
+        {
+            perror("Unable to malloc shadow");
+            exit(1);
+        }
+
+        int n = 0;
+        struct claim *claim;
+        for (claim = claims; claim; claim = claim->next)
+        {
+            ending[n++] = claim;
+        }
+        qsort(ending, n, sizeof(struct claim *), compare_end);
+
+        int i;
+        for (i = 0; i < n && available < reserved_width; i++)
+        {
+            available += ending[i]->width;
+            *shadow = ending[i]->end_ns > now ? ending[i]->end_ns : now;
+        }
+        free(ending);
+    }
+    *extra = available - reserved_width;
+}
+
+/*
+ * Returns 1 if process runs no later than the reserved job in policy order
+ */
+static int ahead_of_reserved(process_p process)
+{
+    process_p holder = reserved;
+    return !holder || process == holder || get_policy_compare()(&process, &holder) < 0;
+}
+
+/*
+ * Returns 1 if a job needing width cores may start now. Jobs after the
+ * reserved one in policy order wait behind it, except under backfill where
+ * they start if they leave the reservation alone, by exiting before the
+ * shadow time or by only using cores that are spare even once the reserved
+ * job starts. Callers hold placement_lock
+ */
+static int may_start(process_p process, int width, long long now)
+{
+    if (width > free_total)
+        return 0;
+    if (ahead_of_reserved(process))
+        return 1;
+    if (policy != BACKFILL)
+        return 0;
+
+    long long shadow;
+    int extra;
+    find_shadow(now, &shadow, &extra);
+    return now + process->cpu_remaining_burst * 1000 <= shadow || width <= extra;
+}
+
+/*
+ * Returns every parked job, oldest first, linked through next. Callers hold
+ * placement_lock
+ */
+static process_p take_parked()
+{
+    process_p waiting = NULL;
+    while (parked)
+    {
+        process_p next = parked->next;
+        parked->next = waiting;
+        waiting = parked;
+        parked = next;
+    }
+    return waiting;
+}
+
+/*
+ * Claims the cores a job asked for. If they are not free, or taking them
+ * would delay the reserved job, the job is parked until release_cpus hands
+ * it back, which happens under the same lock so a release can never slip
+ * between the failed claim and the parking. The first job in policy order
+ * that had to be parked holds the reservation. Jobs parked behind the
+ * reservation may start once it moves, so when it does they are returned in
+ * requeue to be queued again
+ */
+int claim_cpus(process_p process, process_p *requeue)
+{
+    struct claim *claim = calloc(1, sizeof(struct claim));
+    if (claim == NULL)
+    {
+        perror("Unable to malloc claim");
+        exit(1);
+    }
+    claim->width = process->placement.cpus ? process->placement.cpus : 1;
+
+    long long now = now_ns();
+    pthread_mutex_lock(&placement_lock);
+    if (!may_start(process, claim->width, now) || !place(claim, process))
+    {
+        *requeue = NULL;
+        if (ahead_of_reserved(process))
+        {
+            if (reserved != process)
+                *requeue = take_parked();
+            reserved = process;
+            reserved_width = claim->width;
+        }
+        process->next = parked;
+        parked = process;
+        pthread_mutex_unlock(&placement_lock);
+        free(claim);
+        return -1;
+    }
+
+    *requeue = NULL;
+    if (reserved == process)
+    {
+        reserved = NULL;
+        *requeue = take_parked();
+    }
+    claim->end_ns = now + process->cpu_remaining_burst * 1000;
+    claim->next = claims;
+    if (claims)
+        claims->prev = claim;
+    claims = claim;
+    num_claims++;
+    free_total -= claim->width;
+    pthread_mutex_unlock(&placement_lock);
+
+    process->claim = claim;
+    return 0;
+}
+
+/*
+ * Drops the reservation if process holds it. A job parked under backfill
+ * without --cpus is started without claiming cores once the policy no
+ * longer charges it any, it must not stay reserved after it is freed.
+ * Returns the parked jobs to queue again if it held it
+ */
+process_p drop_reservation(process_p process)
+{
+    // only the dispatcher holding process could make it the reserved job
+    if (atomic_load_explicit(&reserved, memory_order_relaxed) != process)
+        return NULL;
+
+    process_p waiting = NULL;
+    pthread_mutex_lock(&placement_lock);
+    if (reserved == process)
+    {
+        reserved = NULL;
+        waiting = take_parked();
+    }
+    pthread_mutex_unlock(&placement_lock);
+    return waiting;
+}
+
+/*
+ * Forgets the reservation on a policy change, the reserved job may no longer
+ * be first in the new order. Returns the parked jobs to queue again, the
+ * first of them in the new order to park takes the reservation
+ */
+process_p reset_reservation()
+{
+    pthread_mutex_lock(&placement_lock);
+    reserved = NULL;
+    process_p waiting = take_parked();
+    pthread_mutex_unlock(&placement_lock);
+    return waiting;
+}
+
+/*
+ * Frees the cores a job held. Every parked job is handed back to be queued
+ * again, oldest first, whether or not its cores are free now it tries again
+ */
+process_p release_cpus(process_p process)
+{
+    struct claim *claim = process->claim;
+    process->claim = NULL;
+
+    pthread_mutex_lock(&placement_lock);
+    int node;
+    for (node = 0; node < num_nodes; node++)
+    {
+        if (!(claim->nodes & (1UL << node)))
+            continue;
+
+        cpu_set_t mine;
+        CPU_AND(&mine, &claim->cpus, &nodes[node].cpus);
+        CPU_OR(&nodes[node].free, &nodes[node].free, &mine);
+        nodes[node].num_free += CPU_COUNT(&mine);
+    }
+
+    if (claim->prev)
+        claim->prev->next = claim->next;
+    else
+        claims = claim->next;
+    if (claim->next)
+        claim->next->prev = claim->prev;
+    num_claims--;
+    free_total += claim->width;
+    process_p waiting = take_parked();
+    pthread_mutex_unlock(&placement_lock);
+
+    free(claim);
+    return waiting;
+}
+
+/*
+ * Returns a malloced copy of the parked jobs and their number in n. They
+ * stay valid while the caller holds every worker lock, a released job cannot
+ * be queued again until those are free
+ */
+process_p *parked_jobs(u_int *n)
+{
+    pthread_mutex_lock(&placement_lock);
+    u_int size = 0;
+    process_p process;
+    for (process = parked; process; process = process->next)
+        size++;
+    process_p *jobs = malloc((size + 1) * sizeof(process_p));
+    if (jobs == NULL)
+    {
+        perror("Unable to malloc parked jobs");
+        exit(1);
+    }
+    *n = 0;
+    for (process = parked; process; process = process->next)
+        jobs[(*n)++] = process;
+    pthread_mutex_unlock(&placement_lock);
+    return jobs;
+}
+
+/*
+ * Returns the number of cores aubatch may use
+ */
+int placement_cores()
+{
+    return total_cpus;
+}
+
+/*
+ * Calls set_mempolicy, which glibc does not wrap
+ */
+static long set_mempolicy(int mode, unsigned long *nodes)
+{
+    return syscall(SYS_set_mempolicy, mode, nodes, nodes ? sizeof(*nodes) * 8 + 1 : 0);
+}
+
+/*
+ * Gives the calling dispatcher the cores and memory policy of a job about to
+ * be spawned, the job inherits both
+ */
+void pin_launcher(process_p process)
+{
+    struct claim *claim = process->claim;
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &claim->cpus))
+        fprintf(stderr, "Warning: unable to pin job %u to its cores\n", process->id);
+
+    if (has_numa && claim->mode != MPOL_DEFAULT && set_mempolicy(claim->mode, &claim->nodes) < 0)
+        fprintf(stderr, "Warning: unable to set the memory policy of job %u: %s\n", process->id, strerror(errno));
+}
+
+/*
+ * Lets the calling dispatcher float over every core again with the default memory policy
+ */
+void unpin_launcher()
+{
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &allowed);
+    if (has_numa)
+        set_mempolicy(MPOL_DEFAULT, NULL);
+}
+
+/*
+ * Packs the placement request into one int, cores in the low 16 bits then
+ * the mode and the node in a byte each
+ */
+int pack_placement(process_p process)
+{
+    return (process->placement.cpus & 0xffff) | (process->placement.numa & 0xff) << 16 | (process->placement.node & 0xff) << 24;
+}
+
+void unpack_placement(process_p process, int packed)
+{
+    process->placement.cpus = packed & 0xffff;
+    process->placement.numa = (packed >> 16) & 0xff;
+    process->placement.node = (packed >> 24) & 0xff;
+}
@@ -0,0 +1,44 @@
+/*
+ * COMP7500/7506
+ * Project 3: placement header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for pinning jobs to cores and numa nodes, used by the
+ * dispatching module, the command line, the socket front end and the journal
+ *
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "modules.h"
+
+#define MAX_NODES 64                         /* numa nodes tracked, one bit each in a node mask */
+#define NODE_PATH "/sys/devices/system/node" /* where the kernel describes the numa nodes */
+
+enum numa_modes
+{
+    NUMA_ANY,        /* cores packed onto one node where they fit, memory left to the kernel */
+    NUMA_LOCAL,      /* cores on a single node and memory bound to it */
+    NUMA_INTERLEAVE, /* cores spread over the nodes and memory interleaved across them */
+    NUMA_NODE,       /* cores on process->node and memory bound to it */
+};
+
+void init_placement();                                           /* reads the numa topology, before any job is launched */
+const char *parse_placement(int *nargs, char **args, placement_t *placement); /* strips --cpus and --numa off a run, NULL or what is wrong */
+const char *check_placement(placement_t *placement);            /* NULL if the cores asked for exist here, otherwise why not */
+int claim_cpus(process_p process, process_p *requeue);          /* claims the cores a job asked for, 0 or -1 with the job parked, requeue gets the parked jobs if the reservation moved */
+process_p release_cpus(process_p process);                       /* frees a job's cores, returns the parked jobs to queue again */
+process_p drop_reservation(process_p process);                   /* for a job started without a claim, returns the parked jobs if it held the reservation */
+process_p reset_reservation();                                   /* forgets the reservation when the policy changes, returns the parked jobs */
+process_p *parked_jobs(u_int *n);                                /* malloced copy of the jobs waiting for cores, for list */
+void pin_launcher(process_p process);                            /* gives this thread the job's cores and memory policy, inherited by the job */
+void unpin_launcher();                                           /* puts this thread back as it was */
+int placement_cores();                                           /* cores aubatch may use */
+int pack_placement(process_p process);                           /* a job's placement request as one int for the journal */
+void unpack_placement(process_p process, int packed);            /* the inverse of pack_placement */
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * COMP7500/7506
+ * Project 3: ready queue
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Provides a growable binary heap of waiting processes keyed by the current
+ * scheduling policy. Insert and pop are O(log n) and there is no hard cap on
+ * the number of waiting processes, the heap doubles whenever it fills up.
+ *
+ * Under the multi-level feedback queue the heap is swapped for one fifo per
+ * level linked through the processes themselves, insert and pop are O(1).
+ *
+ * The queue itself is not thread safe, callers hold the owning worker's lock
+ *
+ */
+
+#include "modules.h"
+
+/*
+ * Swaps two slots in the heap
+ */
+static void swap(process_p *heap, u_int i, u_int j)
+{
+    process_p temp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = temp;
+}
+
+/*
+ * Moves the process at index i up until its parent runs before it
+ */
+static void sift_up(ready_queue_t *rq, u_int i)
+{
+    while (i > 0)
+    {
+        u_int parent = (i - 1) / 2;
+        if (rq->compare(&rq->heap[i], &rq->heap[parent]) >= 0)
+            break;
+        swap(rq->heap, i, parent);
+        i = parent;
+    }
+}
+
+/*
+ * Moves the process at index i down until both children run after it
+ */
+static void sift_down(ready_queue_t *rq, u_int i)
+{
+    while (1)
+    {
+        u_int left = 2 * i + 1;
+        u_int right = left + 1;
+        u_int first = i;
+
+        if (left < rq->size && rq->compare(&rq->heap[left], &rq->heap[first]) < 0)
+            first = left;
+        if (right < rq->size && rq->compare(&rq->heap[right], &rq->heap[first]) < 0)
+            first = right;
+        if (first == i)
+            break;
+        swap(rq->heap, i, first);
+        i = first;
+    }
+}
+
+/*
+ * Sets up an empty ready queue ordered by compare
+ */
+void rq_init(ready_queue_t *rq, compare_t compare)
+{
+    rq->heap = malloc(RQ_INITIAL_SIZE * sizeof(process_p));
+    if (rq->heap == NULL)
+    {
+        perror("Unable to malloc ready queue");
+        exit(1);
+    }
+    rq->size = 0;
+    rq->capacity = RQ_INITIAL_SIZE;
+    rq->compare = compare;
+    rq->levels = NULL;
+    rq->num_levels = 0;
+}
+
+/*
+ * Appends a process to the fifo of its feedback level, levels past the last
+ * one are clamped to the last one
+ */
+static void level_push(ready_queue_t *rq, process_p process)
+{
+    if (process->level >= rq->num_levels)
+        process->level = rq->num_levels - 1;
+
+    level_t *level = &rq->levels[process->level];
+    process->qnext = NULL;
+    if (level->tail)
+        level->tail->qnext = process;
+    else
+        level->head = process;
+    level->tail = process;
+}
+
+/*
+ * Returns the highest level with a waiting process, levels are few so this is constant time
+ */
+static level_t *first_level(ready_queue_t *rq)
+{
+    u_int i;
+    for (i = 0; i < rq->num_levels; i++)
+    {
+        if (rq->levels[i].head)
+            return &rq->levels[i];
+    }
+    return NULL;
+}
+
+/*
+ * Inserts a process into the heap, doubling the heap if it is full
+ */
+void rq_push(ready_queue_t *rq, process_p process)
+{
+    if (rq->num_levels)
+    {
+        level_push(rq, process);
+        rq->size++;
+        return;
+    }
+
+    if (rq->size == rq->capacity)
+    {
+        process_p *heap = realloc(rq->heap, rq->capacity * 2 * sizeof(process_p));
+        if (heap == NULL)
+        {
+            perror("Unable to grow ready queue");
+            exit(1);
+        }
+        rq->heap = heap;
+        rq->capacity *= 2;
+    }
+    rq->heap[rq->size] = process;
+    sift_up(rq, rq->size);
+    rq->size++;
+}
+
+/*
+ * Removes and returns the process that should run next, NULL if the queue is empty
+ */
+process_p rq_pop(ready_queue_t *rq)
+{
+    if (!rq->size)
+        return NULL;
+
+    if (rq->num_levels)
+    {
+        level_t *level = first_level(rq);
+        process_p process = level->head;
+        level->head = process->qnext;
+        if (!level->head)
+            level->tail = NULL;
+        rq->size--;
+        return process;
+    }
+
+    process_p process = rq->heap[0];
+    rq->size--;
+    if (rq->size)
+    {
+        rq->heap[0] = rq->heap[rq->size];
+        sift_down(rq, 0);
+    }
+    return process;
+}
+
+/*
+ * Returns the process that should run next without removing it
+ */
+process_p rq_peek(ready_queue_t *rq)
+{
+    if (!rq->size)
+        return NULL;
+    if (rq->num_levels)
+        return first_level(rq)->head;
+    return rq->heap[0];
+}
+
+/*
+ * Copies every waiting process into out, which must have room for size
+ * entries. Heap entries come out in heap order, levels come out highest first
+ */
+u_int rq_snapshot(ready_queue_t *rq, process_p *out)
+{
+    if (!rq->num_levels)
+    {
+        memcpy(out, rq->heap, rq->size * sizeof(process_p));
+        return rq->size;
+    }
+
+    u_int n = 0;
+    u_int i;
+    for (i = 0; i < rq->num_levels; i++)
+    {
+        process_p process;
+        for (process = rq->levels[i].head; process; process = process->qnext)
+        {
+            out[n++] = process;
+        }
+    }
+    return n;
+}
+
+/*
+ * Rebuilds the queue for a new policy. With levels the waiting processes are
+ * sorted by compare and appended to the fifo of their level, without levels
+ * the heap is rebuilt bottom up in O(n). Also used to apply an mlfq boost
+ */
+void rq_reorder(ready_queue_t *rq, compare_t compare, u_int levels)
+{
+    if (rq->num_levels)
+    {
+        // move the fifos back into the heap array before rebuilding
+        if (rq->capacity < rq->size)
+        {
+            free(rq->heap);
+            rq->capacity = rq->size;
+            rq->heap = malloc(rq->capacity * sizeof(process_p));
+            if (rq->heap == NULL)
+            {
+                perror("Unable to grow ready queue");
+                exit(1);
+            }
+        }
+        rq_snapshot(rq, rq->heap);
+        free(rq->levels);
+        rq->levels = NULL;
+        rq->num_levels = 0;
+    }
+
+    rq->compare = compare;
+
+    if (levels)
+    {
+        rq->levels = calloc(levels, sizeof(level_t));
+        if (rq->levels == NULL)
+        {
+            perror("Unable to malloc feedback levels");
+            exit(1);
+        }
+        rq->num_levels = levels;
+
+        qsort(rq->heap, rq->size, sizeof(process_p), compare);
+        u_int i;
+        for (i = 0; i < rq->size; i++)
+        {
+            level_push(rq, rq->heap[i]);
+        }
+        return;
+    }
+
+    if (rq->size < 2)
+        return;
+
+    u_int i = rq->size / 2;
+    while (i-- > 0)
+    {
+        sift_down(rq, i);
+    }
+}
+
+/*
+ * Frees the memory behind the queue, any processes still in it are left alone
+ */
+void rq_destroy(ready_queue_t *rq)
+{
+    free(rq->heap);
+    free(rq->levels);
+    rq->heap = NULL;
+    rq->levels = NULL;
+    rq->size = 0;
+    rq->capacity = 0;
+    rq->num_levels = 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * COMP7500/7506
+ * Project 3: ready queue header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the ready queue, used by the scheduling and dispatching modules
+ *
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#define RQ_INITIAL_SIZE 16 /* initial number of slots in a ready queue, grows as needed */
+
+struct process;
+
+typedef int (*compare_t)(const void *a, const void *b); /* qsort style comparator over process_p */
+
+typedef struct
+{
+    struct process *head; /* next process to run at this level */
+    struct process *tail; /* last process to join this level */
+} level_t;
+
+typedef struct
+{
+    struct process **heap;  /* binary heap of waiting processes, heap[0] is the next to run */
+    unsigned int size;      /* number of waiting processes */
+    unsigned int capacity;  /* number of allocated slots in heap */
+    compare_t compare;      /* ordering used by the heap, one of the policy schedulers */
+    level_t *levels;        /* one fifo per feedback level, only used when num_levels is set */
+    unsigned int num_levels; /* 0 for a policy ordered heap, otherwise the number of feedback levels */
+} ready_queue_t;
+
+void rq_init(ready_queue_t *rq, compare_t compare);                          /* sets up an empty ready queue */
+void rq_push(ready_queue_t *rq, struct process *process);                     /* inserts process in O(log n), O(1) with levels */
+struct process *rq_pop(ready_queue_t *rq);                                    /* removes and returns the next process, NULL if empty */
+struct process *rq_peek(ready_queue_t *rq);                                   /* returns the next process without removing it */
+void rq_reorder(ready_queue_t *rq, compare_t compare, unsigned int levels);   /* rebuilds the queue for a new policy */
+unsigned int rq_snapshot(ready_queue_t *rq, struct process **out);            /* copies every waiting process into out */
+void rq_destroy(ready_queue_t *rq);                                           /* frees the queue itself, not the processes in it */
+
+#endif
@@ -0,0 +1,606 @@
+/*
+ * COMP7500/7506
+ * Project 3: socket front end
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Lets other programs drive aubatch over a unix domain socket. One thread
+ * serves every client from a single epoll loop, sockets are non blocking and
+ * edge triggered and each client has its own input and output buffer, so a
+ * slow or waiting client never holds up the others
+ *
+ * The runs in everything read from a client at once are handed to the
+ * scheduler as one batch. wait is answered from the completion eventfd
+ * instead of blocking the loop, a waiting client's later commands are held
+ * back until the wait is answered so answers stay in order
+ *
+ */
+
+#define _GNU_SOURCE /* accept4 */
+
+#include "server.h"
+#include "commandline.h"
+#include "modules.h"
+#include "metrics.h"
+#include "placement.h"
+#include "dependency.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+enum waits
+{
+    WAIT_NONE,
+    WAIT_IDLE, /* waiting for every job to finish */
+    WAIT_JOB,  /* waiting for wait_id to finish */
+};
+
+typedef struct client
+{
+    int fd;
+    char *in;          /* bytes read but not yet handled */
+    size_t in_len;
+    size_t in_size;
+    char *out;         /* answers not yet sent */
+    size_t out_len;
+    size_t out_sent;
+    size_t out_size;
+    enum waits wait;   /* wait being answered, later commands are held back */
+    u_int wait_id;
+    int eof;           /* the client closed its side, close once every answer is sent */
+    int overlong;      /* dropping the rest of a line that was too long */
+    struct client *prev, *next;
+
+} client_t;
+
+static int server_epoll;       /* epoll instance watching the listening socket, completions and every client */
+static int server_listen;      /* listening socket */
+static int server_completion;  /* completion eventfd, readable when a job finishes */
+static client_t *clients;      /* every connected client */
+
+static process_p runs[CLIENT_READ / 8]; /* runs read from one client not yet handed to the scheduler */
+static int num_runs;
+
+/*
+ * Makes room for at least extra more bytes in a client buffer
+ */
+static void reserve(char **buffer, size_t *size, size_t len, size_t extra)
+{
+    if (len + extra <= *size)
+        return;
+
+    size_t grown = *size ? *size : 4096;
+    while (grown < len + extra)
+        grown *= 2;
+    char *resized = realloc(*buffer, grown);
+    if (resized == NULL)
+    {
+        perror("Unable to grow client buffer");
+        exit(1);
+    }
+    *buffer = resized;
+    *size = grown;
+}
+
+/*
+ * Appends a formatted line to a client's answers
+ */
+static void reply(client_t *client, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    reserve(&client->out, &client->out_size, client->out_len, length + 2);
+    va_start(args, format);
+    vsnprintf(client->out + client->out_len, length + 1, format, args);
+    va_end(args);
+    client->out_len += length;
+    client->out[client->out_len++] = '\n';
+}
+
+/*
+ * Appends text as payload lines followed by ok, used for the answers that
+ * reuse the command line's output
+ */
+static void reply_text(client_t *client, char *text)
+{
+    char *line = text;
+    while (*line)
+    {
+        char *newline = strchr(line, '\n');
+        if (newline)
+            *newline = '\0';
+        reply(client, PAYLOAD_PREFIX "%s", line);
+        if (!newline)
+            break;
+        line = newline + 1;
+    }
+    reply(client, "ok");
+}
+
+/*
+ * Hands the runs read so far to the scheduler in one batch
+ */
+static void flush_runs()
+{
+    if (!num_runs)
+        return;
+    enqueue_batch(runs, num_runs);
+    num_runs = 0;
+}
+
+/*
+ * Answers the client's wait if it can be answered, returns 1 if it was
+ */
+static int check_wait(client_t *client)
+{
+    if (client->wait == WAIT_IDLE)
+    {
+        if (count)
+            return 0;
+        reply(client, "ok");
+    }
+    else if (client->wait == WAIT_JOB)
+    {
+        int status;
+        if (!poll_job(client->wait_id, &status))
+            return 0;
+        if (status == JOB_UNKNOWN)
+            reply(client, "ok unknown");
+        else
+            reply(client, "ok %d", status);
+    }
+    client->wait = WAIT_NONE;
+    return 1;
+}
+
+/*
+ * run [--after|--afterany <ids>] [--cpus <n>] [--numa <placement>] <job> <time> <priority>
+ */
+static void serve_run(client_t *client, int nargs, char **args)
+{
+    placement_t placement;
+    dependency_t *after;
+    int num_after;
+    const char *error = parse_dependencies(&nargs, args, &after, &num_after);
+    if (!error)
+        error = parse_placement(&nargs, args, &placement);
+    if (!error && nargs != 4)
+        error = "usage: run [--after|--afterany <job_id>,...] [--cpus <n>] [--numa <any|local|interleave|node>] <job> <time> <priority>";
+    if (!error && atof(args[2]) < 0)
+        error = "<time> must not be negative";
+    if (error)
+    {
+        reply(client, "err %s", error);
+        free(after);
+        return;
+    }
+    if (access(args[1], X_OK))
+    {
+        reply(client, "err %s: %s", args[1], strerror(errno));
+        free(after);
+        return;
+    }
+
+    process_p process = get_process(args);
+    process->placement = placement;
+    process->after = after;
+    process->num_after = num_after;
+    runs[num_runs++] = process;
+    if (num_runs == sizeof(runs) / sizeof(runs[0]))
+        flush_runs();
+    reply(client, "ok %u", process->id);
+}
+
+/*
+ * list and metrics, the command line's output captured and sent as payload
+ */
+static void serve_report(client_t *client, int metrics)
+{
+    char *text = NULL;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    if (out == NULL)
+    {
+        reply(client, "err %s", strerror(errno));
+        return;
+    }
+    if (metrics)
+        report_metrics(out, get_policy_string());
+    else
+        list_jobs(out);
+    fclose(out);
+
+    reply_text(client, text);
+    free(text);
+}
+
+/*
+ * policy <name> [<args>], takes the same arguments as the command line
+ */
+static void serve_policy(client_t *client, int nargs, char **args)
+{
+    if (nargs > 1 && find_policy(args[1]))
+    {
+        if (cmd_policy(nargs - 1, args + 1))
+            reply(client, "err invalid arguments for %s", args[1]);
+        else
+            reply(client, "ok %s", get_policy_string());
+        return;
+    }
+
+    char names[MAXCMDLINE];
+    policy_names(names, sizeof(names));
+    reply(client, "err usage: policy <%s> [<args>]", names);
+}
+
+/*
+ * wait [<job_id>]
+ */
+static void serve_wait(client_t *client, int nargs, char **args)
+{
+    if (nargs > 2)
+    {
+        reply(client, "err usage: wait [<job_id>]");
+        return;
+    }
+
+    client->wait = WAIT_IDLE;
+    if (nargs == 2)
+    {
+        char *end;
+        long id = strtol(args[1], &end, 10);
+        int status;
+        if (*end || id < 0 || id > UINT_MAX || poll_job(id, &status) < 0)
+        {
+            client->wait = WAIT_NONE;
+            reply(client, "err no job %s was submitted", args[1]);
+            return;
+        }
+        client->wait = WAIT_JOB;
+        client->wait_id = id;
+    }
+    check_wait(client);
+}
+
+/*
+ * Handles one command line from a client
+ */
+static void serve_line(client_t *client, char *line)
+{
+    char *args[MAXMENUARGS];
+    int nargs = 0;
+    char *word;
+    char *context;
+
+    for (word = strtok_r(line, " \t\r", &context); word; word = strtok_r(NULL, " \t\r", &context))
+    {
+        if (nargs == MAXMENUARGS)
+        {
+            reply(client, "err too many words");
+            return;
+        }
+        args[nargs++] = word;
+    }
+    if (!nargs)
+        return;
+
+    if (!strcmp(args[0], "run"))
+    {
+        serve_run(client, nargs, args);
+        return;
+    }
+
+    // everything else sees the runs that came before it
+    flush_runs();
+    if (!strcmp(args[0], "list"))
+        serve_report(client, 0);
+    else if (!strcmp(args[0], "metrics"))
+        serve_report(client, 1);
+    else if (!strcmp(args[0], "policy"))
+        serve_policy(client, nargs, args);
+    else if (!strcmp(args[0], "wait"))
+        serve_wait(client, nargs, args);
+    else
+        reply(client, "err %s: command not found", args[0]);
+}
+
+/*
+ * Handles every complete line a client has sent, stopping at a wait that
+ * cannot be answered yet. At end of file a last unterminated line counts too
+ */
+static void serve_input(client_t *client)
+{
+    size_t start = 0;
+    while (client->wait == WAIT_NONE && start < client->in_len)
+    {
+        char *line = client->in + start;
+        char *newline = memchr(line, '\n', client->in_len - start);
+        if (newline == NULL)
+        {
+            if (client->eof)
+            {
+                // the last line does not need a newline
+                reserve(&client->in, &client->in_size, client->in_len, 1);
+                line = client->in + start;
+                newline = client->in + client->in_len;
+            }
+            else if (client->in_len - start < MAX_CMD_LEN)
+                break;
+            else
+            {
+                // too long to be a command, drop it up to the next newline
+                if (!client->overlong)
+                    reply(client, "err line too long");
+                client->overlong = 1;
+                start = client->in_len;
+                break;
+            }
+        }
+        *newline = '\0';
+        start = newline - client->in + 1;
+        if (client->overlong)
+        {
+            client->overlong = 0;
+            continue;
+        }
+        serve_line(client, line);
+    }
+    flush_runs();
+
+    if (start >= client->in_len)
+        client->in_len = 0;
+    else if (start)
+    {
+        memmove(client->in, client->in + start, client->in_len - start);
+        client->in_len -= start;
+    }
+}
+
+/*
+ * Sends as much of a client's answers as the socket takes, -1 if the client is gone
+ */
+static int send_answers(client_t *client)
+{
+    while (client->out_sent < client->out_len)
+    {
+        ssize_t sent = send(client->fd, client->out + client->out_sent, client->out_len - client->out_sent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN ? 0 : -1;
+        }
+        client->out_sent += sent;
+    }
+    client->out_len = 0;
+    client->out_sent = 0;
+    return 0;
+}
+
+/*
+ * Reads what a client has sent, returns the bytes read, 0 once the socket is
+ * drained and -1 if the client is gone
+ */
+static ssize_t read_commands(client_t *client)
+{
+    reserve(&client->in, &client->in_size, client->in_len, CLIENT_READ);
+    ssize_t got = read(client->fd, client->in + client->in_len, CLIENT_READ);
+    if (got < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+            return 0;
+        return -1;
+    }
+    if (got == 0)
+        client->eof = 1;
+    client->in_len += got;
+    return got;
+}
+
+/*
+ * Disconnects a client, runs it submitted are unaffected
+ */
+static void close_client(client_t *client)
+{
+    epoll_ctl(server_epoll, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    if (client->prev)
+        client->prev->next = client->next;
+    else
+        clients = client->next;
+    if (client->next)
+        client->next->prev = client->prev;
+    free(client->in);
+    free(client->out);
+    free(client);
+}
+
+/*
+ * Handles, answers and reads from a client until it has nothing more to do.
+ * Reading stops while too many answers are unsent or too much input is held
+ * back behind a wait, the epoll out event or the completion restarts it
+ */
+static void serve_client(client_t *client)
+{
+    while (1)
+    {
+        serve_input(client);
+        if (send_answers(client))
+        {
+            close_client(client);
+            return;
+        }
+        if (client->eof || client->out_len >= CLIENT_BACKLOG || client->in_len >= CLIENT_BACKLOG)
+            break;
+
+        ssize_t got = read_commands(client);
+        if (got < 0)
+        {
+            close_client(client);
+            return;
+        }
+        if (!got)
+            break;
+    }
+
+    if (client->eof && client->wait == WAIT_NONE && !client->in_len && !client->out_len)
+        close_client(client);
+}
+
+/*
+ * Accepts every pending connection
+ */
+static void accept_clients()
+{
+    while (1)
+    {
+        int fd = accept4(server_listen, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EINTR)
+                perror("Unable to accept client");
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        client_t *client = calloc(1, sizeof(client_t));
+        if (client == NULL)
+        {
+            perror("Unable to malloc client");
+            exit(1);
+        }
+        client->fd = fd;
+        client->next = clients;
+        if (clients)
+            clients->prev = client;
+        clients = client;
+
+        struct epoll_event event = {.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = client};
+        if (epoll_ctl(server_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            perror("Unable to watch client");
+            close_client(client);
+            continue;
+        }
+        serve_client(client);
+    }
+}
+
+/*
+ * Answers every wait a finished job may have satisfied
+ */
+static void answer_waits()
+{
+    uint64_t completed;
+    if (read(server_completion, &completed, sizeof(completed)) < 0 && errno != EAGAIN)
+        perror("Unable to read completions");
+
+    client_t *client = clients;
+    while (client)
+    {
+        client_t *next = client->next;
+        if (client->wait != WAIT_NONE && check_wait(client))
+            serve_client(client);
+        client = next;
+    }
+}
+
+/*
+ * Binds the listening socket at path. A socket file left behind by an
+ * aubatch that is no longer running is replaced, a live one is not
+ */
+int init_server(const char *path)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    server_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server_listen < 0)
+    {
+        perror("Unable to create socket");
+        return -1;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && !connect(probe, (struct sockaddr *)&address, sizeof(address)))
+    {
+        fprintf(stderr, "Another aubatch is already listening on %s\n", path);
+        close(probe);
+        return -1;
+    }
+    if (probe >= 0)
+        close(probe);
+    unlink(path);
+
+    if (bind(server_listen, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(server_listen, SOMAXCONN) < 0)
+    {
+        perror("Unable to listen on socket");
+        return -1;
+    }
+
+    server_epoll = epoll_create1(EPOLL_CLOEXEC);
+    server_completion = completion_eventfd();
+    struct epoll_event listen_event = {.events = EPOLLIN, .data.ptr = &server_listen};
+    struct epoll_event completion_event = {.events = EPOLLIN, .data.ptr = &server_completion};
+    if (server_epoll < 0 || server_completion < 0 ||
+        epoll_ctl(server_epoll, EPOLL_CTL_ADD, server_listen, &listen_event) < 0 ||
+        epoll_ctl(server_epoll, EPOLL_CTL_ADD, server_completion, &completion_event) < 0)
+    {
+        perror("Unable to create server epoll");
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Socket front end, accepts clients and serves their commands
+ */
+void *server(void *ptr)
+{
+    struct epoll_event events[SERVER_EVENTS];
+
+    while (1)
+    {
+        int n = epoll_wait(server_epoll, events, SERVER_EVENTS, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("Server epoll_wait failed");
+            exit(1);
+        }
+
+        int i;
+        int completed = 0;
+        for (i = 0; i < n; i++)
+        {
+            if (events[i].data.ptr == &server_listen)
+                accept_clients();
+            else if (events[i].data.ptr == &server_completion)
+                completed = 1;
+            else
+                serve_client(events[i].data.ptr);
+        }
+
+        // waits are answered last, a client closed while answering can then no
+        // longer turn up later in this batch of events
+        if (completed)
+            answer_waits();
+    }
+    return (void *)NULL;
+}
@@ -0,0 +1,42 @@
+/*
+ * COMP7500/7506
+ * Project 3: socket front end header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the unix domain socket front end, shared by aubatch and
+ * aubatch-client
+ *
+ * The protocol is one command per line, answered in order. Each command gets
+ * any number of payload lines starting with "* " followed by one status line,
+ * either "ok" with an optional value or "err" with a message. Blank lines get
+ * no answer
+ *
+ *   run <job> <time> <priority>      ok <job_id>
+ *   run --cpus <n> [--numa <any|local|interleave|node>] <job> <time> <priority>
+ *   list                             * <list table>, ok
+ *   metrics                          * <metrics report>, ok
+ *   policy <fcfs|sjf|priority|srtf|backfill>  ok <policy>
+ *   policy rr <quantum_ms>
+ *   policy mlfq [<quanta>] [<boost_ms>]
+ *   wait                             ok once every job has finished
+ *   wait <job_id>                    ok <exit_status> once the job has finished,
+ *                                    ok unknown if it finished before a restart
+ *
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#define DEFAULT_SOCKET "/tmp/aubatch.sock" /* socket aubatch-client connects to without -s */
+#define SERVER_EVENTS 64                  /* epoll events handled per wakeup */
+#define CLIENT_READ 65536                 /* bytes read from a client at a time */
+#define CLIENT_BACKLOG (1 << 20)          /* buffered bytes after which a client's input is left unread */
+#define PAYLOAD_PREFIX "* "               /* starts every payload line of an answer */
+
+int init_server(const char *path); /* listens on path, 0 on success */
+void *server(void *ptr);           /* serves clients until aubatch exits */
+
+#endif
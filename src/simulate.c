@@ -0,0 +1,130 @@
+/*
+ * COMP7500/7506
+ * Project 3: simulator
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Runs a benchmark in virtual time instead of launching microbatch. Jobs are
+ * built exactly as `test` builds them and ordered by the same ready queue and
+ * policy comparators, with num_slots jobs on the cpu at once. Time only moves
+ * from one event to the next, an arrival or a job finishing, so thousands of
+ * jobs take milliseconds. Finished jobs are kept in the simulation's own
+ * metrics, never in the live ones, the exports or the job log
+ *
+ * Launch and reap overheads are not modelled, every job starts the instant
+ * a slot frees up and runs for exactly its burst
+ *
+ */
+
+#include "simulate.h"
+
+#include <limits.h>
+
+/*
+ * Orders running jobs by the virtual time they finish at, used by the
+ * completion queue
+ */
+static int finish_order(const void *a, const void *b)
+{
+    process_p process_a = *(process_p *)a;
+    process_p process_b = *(process_p *)b;
+
+    if (process_a->exit_ns != process_b->exit_ns)
+        return (process_a->exit_ns < process_b->exit_ns) ? -1 : 1;
+    return (process_a->id < process_b->id) ? -1 : (process_a->id > process_b->id);
+}
+
+/*
+ * Records a job that finished at virtual time now in the simulation, the
+ * same way finish_process records a real one
+ */
+static void finish_simulated(simulation_t *simulation, process_p process, time_t start, long long now)
+{
+    finished_process_t finished;
+    memset(&finished, 0, sizeof(finished));
+
+    strcpy(finished.cmd, process->cmd);
+    finished.id = process->id;
+    finished.arrival_time = start + process->submit_ns / 1000000000LL;
+    finished.cpu_burst = process->cpu_burst;
+    finished.priority = process->priority;
+    finished.cpus = 1;
+    finished.submit_ns = process->submit_ns;
+    finished.enqueue_ns = process->enqueue_ns;
+    finished.dispatch_ns = process->dispatch_ns;
+    finished.exec_ns = process->exec_ns;
+    finished.exit_ns = now;
+    finished.reaped_ns = now;
+    finished.turnaround_time = (now - process->submit_ns) / 1000;
+    finished.waiting_time = finished.turnaround_time - process->cpu_burst;
+    finished.response_time = (process->exec_ns - process->submit_ns) / 1000;
+
+    add_finished(simulation->metrics, &finished);
+    simulation->recent[simulation->recent_head % RECENT_JOBS] = finished;
+    simulation->recent_head++;
+    free(process);
+}
+
+/*
+ * Simulates num_of_jobs benchmark jobs drawn from workload, ordered by
+ * compare. Jobs and interarrival gaps are drawn in the same order as
+ * test_scheduler draws them, so the same seed gives the same jobs
+ *
+ * All events at one instant are handled before any job is dispatched, so a
+ * batch arriving together is ordered as a whole like enqueue_batch orders it
+ *
+ * Returns the virtual time at which the last job finished
+ */
+long long simulate_scheduler(simulation_t *simulation, compare_t compare, workload_t *workload, int num_of_jobs)
+{
+    ready_queue_t waiting; /* jobs that have arrived and wait for a slot */
+    ready_queue_t running; /* jobs on a slot, ordered by finish time */
+    rq_init(&waiting, compare);
+    rq_init(&running, finish_order);
+
+    time_t start = time(NULL);
+    long long now = 0;
+    long long next_arrival = 0;
+    int arrived = 0;
+
+    while (arrived < num_of_jobs || waiting.size || running.size)
+    {
+        if (arrived == num_of_jobs)
+            next_arrival = LLONG_MAX;
+        process_p next_done = rq_peek(&running);
+        long long next_finish = next_done ? next_done->exit_ns : LLONG_MAX;
+        now = next_arrival < next_finish ? next_arrival : next_finish;
+
+        // finish every job due now, then let every job due now arrive
+        while ((next_done = rq_peek(&running)) && next_done->exit_ns == now)
+        {
+            finish_simulated(simulation, rq_pop(&running), start, now);
+        }
+        while (arrived < num_of_jobs && next_arrival == now)
+        {
+            process_p process = new_test_process(workload);
+            process->id = arrived++;
+            process->submit_ns = now;
+            process->enqueue_ns = now;
+            rq_push(&waiting, process);
+
+            if (workload->interarrival > 0 && arrived < num_of_jobs)
+                next_arrival += workload_interarrival(workload);
+        }
+
+        while (running.size < num_slots && waiting.size)
+        {
+            process_p process = rq_pop(&waiting);
+            process->dispatch_ns = now;
+            process->exec_ns = now;
+            process->exit_ns = now + process->cpu_burst * 1000;
+            rq_push(&running, process);
+        }
+    }
+
+    rq_destroy(&waiting);
+    rq_destroy(&running);
+    return now;
+}
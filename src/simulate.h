@@ -0,0 +1,28 @@
+/*
+ * COMP7500/7506
+ * Project 3: simulator header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the discrete-event simulator, used by commandline
+ *
+ */
+
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include "metrics.h"
+
+typedef struct
+{
+    metrics_t *metrics;                     /* the simulated jobs, kept apart from the live jobs */
+    finished_process_t recent[RECENT_JOBS]; /* ring of the last simulated jobs to finish */
+    long long recent_head;                  /* number of jobs put in recent */
+
+} simulation_t;
+
+long long simulate_scheduler(simulation_t *simulation, compare_t compare, workload_t *workload, int num_of_jobs); /* runs a benchmark in virtual time, returns the simulated makespan in ns */
+
+#endif
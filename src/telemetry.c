@@ -0,0 +1,412 @@
+/*
+ * COMP7500/7506
+ * Project 3: telemetry
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Live counters for monitoring, served in the Prometheus text format over
+ * http on a loopback port or a unix socket (-m). Unlike the metrics module,
+ * which only sees finished jobs and is cleared between benchmarks, these
+ * count from the start and follow jobs as they move through the scheduler
+ *
+ * Each thread that submits, dispatches or finishes jobs owns a shard of the
+ * counters and is its only writer, like the metrics shards, so counting takes
+ * no lock and a scrape only reads. Gauges are kept as up down counters that
+ * may go negative in one shard, only their sum over every shard means anything
+ *
+ */
+
+#define _GNU_SOURCE /* accept4 */
+
+#include "telemetry.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+/* upper bounds of the dispatch latency buckets, in nanoseconds */
+static const long long latency_bounds[LATENCY_BUCKETS] = {
+    100000LL, 250000LL, 500000LL,
+    1000000LL, 2500000LL, 5000000LL,
+    10000000LL, 25000000LL, 50000000LL,
+    100000000LL, 250000000LL, 500000000LL,
+    1000000000LL, 2500000000LL, 5000000000LL,
+    10000000000LL};
+
+static _Atomic(counters_t *) shards;    /* every shard ever handed out */
+static _Thread_local counters_t *shard; /* the shard owned by this thread */
+static int telemetry_listen = -1;       /* listening socket, -1 until telemetry_open */
+
+/*
+ * Adds value to a counter only this thread writes
+ */
+static void bump(atomic_llong *counter, long long value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+/*
+ * Returns the shard owned by this thread, the first call from a thread
+ * allocates it and pushes it on the shard list
+ */
+static counters_t *get_shard()
+{
+    if (shard)
+        return shard;
+
+    shard = calloc(1, sizeof(counters_t));
+    if (shard == NULL)
+    {
+        perror("Unable to malloc counters");
+        exit(1);
+    }
+
+    counters_t *head = atomic_load(&shards);
+    do
+    {
+        shard->next = head;
+    } while (!atomic_compare_exchange_weak(&shards, &head, shard));
+    return shard;
+}
+
+/*
+ * Returns the breakdown a priority is counted under, the same one as the metrics report
+ */
+static int priority_index(int priority)
+{
+    if (priority < 0)
+        return 0;
+    if (priority >= PRIORITY_STATS)
+        return PRIORITY_STATS - 1;
+    return priority;
+}
+
+void telemetry_submit(process_p *processes, int n)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->submitted, n);
+
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        bump(&counters->waiting[priority_index(processes[i]->priority)], 1);
+    }
+}
+
+/*
+ * Counts a job leaving a run queue, its dispatch latency is only observed the
+ * first time, a preempted job has already been launched
+ */
+void telemetry_dispatch(process_p process)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->waiting[priority_index(process->priority)], -1);
+    if (process->pid > 0)
+        return;
+
+    long long latency = process->dispatch_ns - process->enqueue_ns;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS && latency > latency_bounds[bucket])
+        bucket++;
+    bump(&counters->latency[bucket], 1);
+    bump(&counters->latency_sum, latency);
+}
+
+void telemetry_launch(process_p process, int err)
+{
+    counters_t *counters = get_shard();
+    if (err)
+        bump(&counters->launch_failures, 1);
+    else
+    {
+        bump(&counters->launched, 1);
+        bump(&counters->running, 1);
+    }
+}
+
+void telemetry_resume(process_p process)
+{
+    bump(&get_shard()->running, 1);
+}
+
+void telemetry_preempt(process_p process)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->preemptions, 1);
+    bump(&counters->running, -1);
+    bump(&counters->waiting[priority_index(process->priority)], 1);
+}
+
+/*
+ * Counts a finished job, only one that was launched was running
+ */
+void telemetry_finish(process_p process, int status)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->finished, 1);
+    if (status)
+        bump(&counters->failed, 1);
+    if (process->pid > 0)
+        bump(&counters->running, -1);
+}
+
+/*
+ * Held jobs are not waiting to be dispatched, they move from waiting to held
+ * and back once released
+ */
+void telemetry_hold(process_p process)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->waiting[priority_index(process->priority)], -1);
+    bump(&counters->held, 1);
+}
+
+void telemetry_release(process_p process)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->held, -1);
+    bump(&counters->waiting[priority_index(process->priority)], 1);
+}
+
+void telemetry_cancel(process_p process)
+{
+    counters_t *counters = get_shard();
+    bump(&counters->held, -1);
+    bump(&counters->cancelled, 1);
+}
+
+/*
+ * Returns every shard summed into totals
+ */
+static void sum_shards(counters_t *totals)
+{
+    memset(totals, 0, sizeof(counters_t));
+
+    counters_t *from;
+    for (from = atomic_load(&shards); from; from = from->next)
+    {
+        bump(&totals->submitted, atomic_load_explicit(&from->submitted, memory_order_relaxed));
+        bump(&totals->launched, atomic_load_explicit(&from->launched, memory_order_relaxed));
+        bump(&totals->launch_failures, atomic_load_explicit(&from->launch_failures, memory_order_relaxed));
+        bump(&totals->finished, atomic_load_explicit(&from->finished, memory_order_relaxed));
+        bump(&totals->failed, atomic_load_explicit(&from->failed, memory_order_relaxed));
+        bump(&totals->preemptions, atomic_load_explicit(&from->preemptions, memory_order_relaxed));
+        bump(&totals->cancelled, atomic_load_explicit(&from->cancelled, memory_order_relaxed));
+        bump(&totals->held, atomic_load_explicit(&from->held, memory_order_relaxed));
+        bump(&totals->running, atomic_load_explicit(&from->running, memory_order_relaxed));
+        bump(&totals->latency_sum, atomic_load_explicit(&from->latency_sum, memory_order_relaxed));
+
+        int i;
+        for (i = 0; i < PRIORITY_STATS; i++)
+        {
+            bump(&totals->waiting[i], atomic_load_explicit(&from->waiting[i], memory_order_relaxed));
+        }
+        for (i = 0; i <= LATENCY_BUCKETS; i++)
+        {
+            bump(&totals->latency[i], atomic_load_explicit(&from->latency[i], memory_order_relaxed));
+        }
+    }
+}
+
+/*
+ * Prints a counter or a gauge without labels, with its help and type lines
+ */
+static void write_metric(FILE *out, const char *name, const char *type, const char *help, double value)
+{
+    fprintf(out, "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+}
+
+/*
+ * Prints every counter in the Prometheus text format
+ */
+static void write_counters(FILE *out)
+{
+    counters_t totals;
+    sum_shards(&totals);
+
+#define TOTAL(field) atomic_load_explicit(&totals.field, memory_order_relaxed)
+
+    // a gauge summed while jobs move may be caught halfway, never show less than nothing
+    long long running = TOTAL(running) > 0 ? TOTAL(running) : 0;
+    long long held = TOTAL(held) > 0 ? TOTAL(held) : 0;
+    long long attempts = TOTAL(launched) + TOTAL(launch_failures);
+
+    write_metric(out, "aubatch_jobs_submitted_total", "counter", "Jobs submitted.", TOTAL(submitted));
+    write_metric(out, "aubatch_jobs_launched_total", "counter", "Jobs launched, resumes after a preemption not included.", TOTAL(launched));
+    write_metric(out, "aubatch_launch_failures_total", "counter", "Jobs that could not be launched.", TOTAL(launch_failures));
+    write_metric(out, "aubatch_launch_failure_ratio", "gauge", "Share of launch attempts that failed.",
+                 attempts ? (double)TOTAL(launch_failures) / attempts : 0);
+    write_metric(out, "aubatch_jobs_finished_total", "counter", "Jobs finished, launch failures included.", TOTAL(finished));
+    write_metric(out, "aubatch_jobs_failed_total", "counter", "Jobs finished with a non zero exit status.", TOTAL(failed));
+    write_metric(out, "aubatch_jobs_cancelled_total", "counter", "Jobs cancelled as a job they ran --after failed, also counted as failed.", TOTAL(cancelled));
+    write_metric(out, "aubatch_preemptions_total", "counter", "Time slices taken away from running jobs.", TOTAL(preemptions));
+    write_metric(out, "aubatch_jobs_running", "gauge", "Jobs on the cpu.", running);
+    write_metric(out, "aubatch_jobs_held", "gauge", "Jobs waiting on jobs they ran --after.", held);
+    write_metric(out, "aubatch_jobs_unfinished", "gauge", "Jobs submitted and not yet finished.", atomic_load(&count));
+    write_metric(out, "aubatch_job_slots", "gauge", "Most jobs allowed to run at once.", num_slots);
+
+    fprintf(out, "# HELP aubatch_queue_depth Jobs waiting to be dispatched, by policy and priority.\n# TYPE aubatch_queue_depth gauge\n");
+    int i;
+    for (i = 0; i < PRIORITY_STATS; i++)
+    {
+        // the first and last breakdowns also hold the priorities outside it
+        char label[16];
+        if (i == PRIORITY_STATS - 1)
+            snprintf(label, sizeof(label), "%d+", i);
+        else if (i == 0)
+            snprintf(label, sizeof(label), "<=0");
+        else
+            snprintf(label, sizeof(label), "%d", i);
+
+        long long depth = TOTAL(waiting[i]);
+        fprintf(out, "aubatch_queue_depth{policy=\"%s\",priority=\"%s\"} %lld\n", get_policy_string(), label, depth > 0 ? depth : 0);
+    }
+
+    fprintf(out, "# HELP aubatch_dispatch_latency_seconds Time from joining a run queue to the first dispatch.\n# TYPE aubatch_dispatch_latency_seconds histogram\n");
+    long long cumulative = 0;
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        cumulative += TOTAL(latency[i]);
+        fprintf(out, "aubatch_dispatch_latency_seconds_bucket{le=\"%g\"} %lld\n", latency_bounds[i] / 1e9, cumulative);
+    }
+    cumulative += TOTAL(latency[LATENCY_BUCKETS]);
+    fprintf(out, "aubatch_dispatch_latency_seconds_bucket{le=\"+Inf\"} %lld\n", cumulative);
+    fprintf(out, "aubatch_dispatch_latency_seconds_sum %.9f\n", TOTAL(latency_sum) / 1e9);
+    fprintf(out, "aubatch_dispatch_latency_seconds_count %lld\n", cumulative);
+
+#undef TOTAL
+}
+
+/*
+ * Answers one scrape. Whatever the request, only GET / and GET /metrics get
+ * the counters. The socket times out so a stuck scraper cannot hold the
+ * endpoint for long
+ */
+static void serve_scrape(int fd)
+{
+    struct timeval timeout = {.tv_sec = TELEMETRY_TIMEOUT};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // the request line is all that matters, read until the end of the headers
+    char request[TELEMETRY_REQUEST + 1];
+    size_t len = 0;
+    while (len < TELEMETRY_REQUEST)
+    {
+        ssize_t got = read(fd, request + len, TELEMETRY_REQUEST - len);
+        if (got <= 0)
+            break;
+        len += got;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n"))
+            break;
+    }
+    request[len] = '\0';
+
+    char *body = NULL;
+    size_t body_len = 0;
+    FILE *out = open_memstream(&body, &body_len);
+    if (out == NULL)
+        return;
+
+    const char *status = "200 OK";
+    if (!strncmp(request, "GET /metrics", 12) || !strncmp(request, "GET / ", 6))
+        write_counters(out);
+    else
+    {
+        status = "404 Not Found";
+        fprintf(out, "Not found, the counters are served on /metrics\n");
+    }
+    fclose(out);
+
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                              status, body_len);
+
+    struct iovec parts[2] = {{header, header_len}, {body, body_len}};
+    if (writev(fd, parts, 2) < 0 && errno != EPIPE)
+        perror("Unable to answer scrape");
+    free(body);
+}
+
+/*
+ * Telemetry thread, answers one scraper at a time. A scrape only reads the
+ * shards, it never takes a lock the scheduler uses
+ */
+static void *telemetry(void *ptr)
+{
+    while (1)
+    {
+        int fd = accept4(telemetry_listen, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EINTR && errno != ECONNABORTED)
+                perror("Unable to accept scrape");
+            continue;
+        }
+        serve_scrape(fd);
+        close(fd);
+    }
+    return (void *)NULL;
+}
+
+/*
+ * Binds a loopback tcp port if endpoint is a number, otherwise a unix socket
+ * at endpoint, replacing any socket file left there
+ */
+static int bind_endpoint(const char *endpoint)
+{
+    if (strspn(endpoint, "0123456789") == strlen(endpoint))
+    {
+        struct sockaddr_in address = {
+            .sin_family = AF_INET,
+            .sin_port = htons(atoi(endpoint)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+
+        telemetry_listen = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        if (telemetry_listen >= 0)
+            setsockopt(telemetry_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        return telemetry_listen < 0 ? -1 : bind(telemetry_listen, (struct sockaddr *)&address, sizeof(address));
+    }
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(endpoint) >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(address.sun_path, endpoint);
+
+    telemetry_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (telemetry_listen < 0)
+        return -1;
+    unlink(endpoint);
+    return bind(telemetry_listen, (struct sockaddr *)&address, sizeof(address));
+}
+
+/*
+ * Starts serving the counters on endpoint
+ */
+int telemetry_open(const char *endpoint)
+{
+    if (bind_endpoint(endpoint) < 0 || listen(telemetry_listen, SOMAXCONN) < 0)
+    {
+        fprintf(stderr, "Unable to serve metrics on %s: %s\n", endpoint, strerror(errno));
+        return -1;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, telemetry, (void *)NULL))
+    {
+        perror("Unable to start telemetry thread");
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
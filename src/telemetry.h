@@ -0,0 +1,53 @@
+/*
+ * COMP7500/7506
+ * Project 3: telemetry header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the live counters and the endpoint serving them in the
+ * Prometheus text format, used by the scheduling module and the main driver
+ *
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "modules.h"
+#include "metrics.h"
+
+#define TELEMETRY_REQUEST 4096 /* bytes of a scrape request that are read, the rest is ignored */
+#define TELEMETRY_TIMEOUT 1    /* seconds a scraper gets to send its request and take the answer */
+#define LATENCY_BUCKETS 16     /* finite buckets of the dispatch latency histogram */
+
+typedef struct counters
+{
+    atomic_llong submitted;                /* jobs handed to enqueue_process or enqueue_batch */
+    atomic_llong launched;                 /* jobs launched, resumes not included */
+    atomic_llong launch_failures;          /* jobs that could not be launched */
+    atomic_llong finished;                 /* jobs finished, launch failures included */
+    atomic_llong failed;                   /* jobs finished with a non zero exit status */
+    atomic_llong preemptions;              /* time slices taken away from a running job */
+    atomic_llong cancelled;                /* jobs cancelled as a job they ran --after failed */
+    atomic_llong held;                     /* up down counter of jobs waiting on unfinished jobs */
+    atomic_llong running;                  /* up down counter of jobs on the cpu */
+    atomic_llong waiting[PRIORITY_STATS];  /* up down counters of jobs waiting to be dispatched, by priority */
+    atomic_llong latency[LATENCY_BUCKETS + 1]; /* first dispatches by latency bucket, the last one is past every bound */
+    atomic_llong latency_sum;              /* enqueue to first dispatch over every job, in nanoseconds */
+    struct counters *next;                 /* next shard, every thread that schedules owns one */
+
+} counters_t;
+
+int telemetry_open(const char *endpoint);            /* serves the counters on a loopback port or a unix socket, 0 on success */
+void telemetry_submit(process_p *processes, int n);  /* counts new jobs as waiting */
+void telemetry_dispatch(process_p process);          /* counts a job taken off a run queue */
+void telemetry_launch(process_p process, int err);   /* counts a launch, err is 0 if it worked */
+void telemetry_resume(process_p process);            /* counts a preempted job put back on the cpu */
+void telemetry_preempt(process_p process);           /* counts a running job put back on a run queue */
+void telemetry_finish(process_p process, int status); /* counts a finished job */
+void telemetry_hold(process_p process);              /* counts a new job held back by its dependencies */
+void telemetry_release(process_p process);           /* counts a held job whose dependencies finished */
+void telemetry_cancel(process_p process);            /* counts a held job that will never run */
+
+#endif
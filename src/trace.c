@@ -0,0 +1,191 @@
+/*
+ * COMP7500/7506
+ * Project 3: trace replay
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Replays a recorded trace against the live scheduler. The trace is streamed
+ * one line at a time through a large stdio buffer, so memory stays constant
+ * however long the trace is. Two formats are read:
+ *
+ *   Standard Workload Format (.swf), whitespace separated fields where field 2
+ *   is the submit time, field 4 the run time and field 15 the queue number,
+ *   used as the priority. Lines starting with ';' are comments
+ *
+ *   CSV (.csv), submit_time,runtime,priority[,command] with an optional
+ *   header line. Jobs without a command run microbatch for their runtime
+ *
+ */
+
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ctype.h>
+
+/*
+ * Opens a trace for streaming, the format is picked by the file extension
+ */
+int trace_open(trace_t *trace, const char *path)
+{
+    trace->file = fopen(path, "r");
+    if (trace->file == NULL)
+        return -1;
+
+    // the trace is read once front to back
+    setvbuf(trace->file, NULL, _IOFBF, TRACE_BUFFER);
+    posix_fadvise(fileno(trace->file), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    size_t length = strlen(path);
+    trace->csv = length > 4 && !strcmp(path + length - 4, ".csv");
+    trace->line = 0;
+    return 0;
+}
+
+void trace_close(trace_t *trace)
+{
+    fclose(trace->file);
+}
+
+/*
+ * Parses one standard workload format line, returns 0 for jobs that cannot
+ * be replayed such as cancelled jobs with no run time
+ */
+static int parse_swf(char *line, trace_job_t *job)
+{
+    double fields[18];
+    int n = 0;
+    char *word;
+    char *context;
+    for (word = strtok_r(line, " \t\r\n", &context); word && n < 18; word = strtok_r(NULL, " \t\r\n", &context))
+    {
+        fields[n++] = atof(word);
+    }
+    if (n < 4 || fields[1] < 0 || fields[3] < 0)
+        return 0;
+
+    job->submit = fields[1];
+    job->runtime = fields[3];
+    job->priority = n >= 15 && fields[14] >= 0 ? (int)fields[14] : 1;
+    strcpy(job->cmd, TRACE_DEFAULT_CMD);
+    return 1;
+}
+
+/*
+ * Parses one csv line, returns 0 for the header and malformed lines
+ */
+static int parse_csv(char *line, trace_job_t *job)
+{
+    char *end;
+    job->submit = strtod(line, &end);
+    if (end == line || *end != ',')
+        return 0;
+
+    char *field = end + 1;
+    job->runtime = strtod(field, &end);
+    if (end == field || *end != ',' || job->runtime < 0)
+        return 0;
+
+    field = end + 1;
+    job->priority = strtol(field, &end, 10);
+    if (end == field)
+        return 0;
+
+    // the command is everything after the priority, less surrounding space
+    strcpy(job->cmd, TRACE_DEFAULT_CMD);
+    if (*end == ',')
+    {
+        char *cmd = end + 1;
+        while (isspace((unsigned char)*cmd))
+            cmd++;
+        remove_newline(cmd);
+        size_t length = strlen(cmd);
+        while (length && isspace((unsigned char)cmd[length - 1]))
+            cmd[--length] = '\0';
+        if (length)
+            snprintf(job->cmd, MAX_CMD_LEN, "%s", cmd);
+    }
+    return 1;
+}
+
+/*
+ * Reads the next replayable job from the trace, returns 0 at the end. Blank
+ * lines, comments, headers and lines too long for the buffer are skipped
+ */
+int trace_next(trace_t *trace, trace_job_t *job)
+{
+    while (fgets(trace->buffer, TRACE_LINE_LEN, trace->file))
+    {
+        trace->line++;
+        size_t length = strlen(trace->buffer);
+        if (length == TRACE_LINE_LEN - 1 && trace->buffer[length - 1] != '\n')
+        {
+            // skip the rest of an overlong line
+            int c;
+            while ((c = fgetc(trace->file)) != EOF && c != '\n')
+            {
+            }
+            fprintf(stderr, "Warning: trace line %lld is too long, skipped\n", trace->line);
+            continue;
+        }
+
+        char *line = trace->buffer;
+        while (isspace((unsigned char)*line))
+            line++;
+        if (*line == '\0' || *line == ';' || *line == '#')
+            continue;
+
+        if (trace->csv ? parse_csv(line, job) : parse_swf(line, job))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Sleeps until the monotonic clock reaches deadline_ns
+ */
+static void sleep_until(long long deadline_ns)
+{
+    struct timespec deadline = {deadline_ns / 1000000000LL, deadline_ns % 1000000000LL};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    {
+    }
+}
+
+/*
+ * Submits every job of the trace at its recorded offset from the first job.
+ * With a scale above 1 the trace plays faster, offsets and run times are
+ * both divided by scale so the load on the job slots stays the same
+ *
+ * Returns the number of jobs submitted, or -1 if the trace cannot be opened
+ */
+long long replay_trace(const char *path, double scale)
+{
+    trace_t trace;
+    if (trace_open(&trace, path))
+        return -1;
+
+    trace_job_t job;
+    long long submitted = 0;
+    long long start = now_ns();
+    double first = 0;
+    while (trace_next(&trace, &job))
+    {
+        if (!submitted)
+            first = job.submit;
+
+        // traces are meant to be sorted, a job recorded early is submitted straight away
+        double offset = (job.submit - first) / scale;
+        if (offset > 0)
+            sleep_until(start + (long long)(offset * 1e9));
+
+        process_p process = new_process(job.cmd, (long long)(job.runtime / scale * 1e6 + 0.5), job.priority);
+        enqueue_process(process);
+        submitted++;
+    }
+
+    trace_close(&trace);
+    return submitted;
+}
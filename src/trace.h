@@ -0,0 +1,45 @@
+/*
+ * COMP7500/7506
+ * Project 3: trace replay header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for replaying recorded job traces, used by commandline
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "modules.h"
+
+#define TRACE_LINE_LEN 4096         /* longest trace line, longer lines are skipped */
+#define TRACE_BUFFER (1 << 20)      /* stdio buffer for streaming a trace */
+#define TRACE_DEFAULT_CMD "./microbatch.out" /* command run for swf jobs and csv jobs without one */
+
+typedef struct
+{
+    FILE *file;
+    int csv;                   /* simple csv instead of standard workload format */
+    long long line;            /* line number of the last line read, for warnings */
+    char buffer[TRACE_LINE_LEN];
+
+} trace_t;
+
+typedef struct
+{
+    double submit;  /* seconds from the start of the trace */
+    double runtime; /* seconds */
+    int priority;
+    char cmd[MAX_CMD_LEN];
+
+} trace_job_t;
+
+int trace_open(trace_t *trace, const char *path);   /* opens a trace, csv if the name ends in .csv */
+int trace_next(trace_t *trace, trace_job_t *job);   /* reads the next job, 0 at the end of the trace */
+void trace_close(trace_t *trace);
+long long replay_trace(const char *path, double scale); /* submits every job of a trace at its recorded offset, returns the jobs submitted or -1 */
+
+#endif
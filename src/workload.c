@@ -0,0 +1,206 @@
+/*
+ * COMP7500/7506
+ * Project 3: workload generator
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Draws benchmark jobs from configurable distributions: fixed or poisson
+ * arrivals, uniform, bounded pareto or lognormal bursts and uniform or zipf
+ * priorities. Each workload has its own seeded xoshiro256** generator so a
+ * seed always gives the same jobs, whoever else calls rand()
+ *
+ */
+
+#include "workload.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/*
+ * splitmix64, only used to spread the seed over the generator state
+ */
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * xoshiro256**, returns the next 64 random bits
+ */
+static uint64_t next_bits(workload_t *workload)
+{
+    uint64_t *s = workload->state;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+/*
+ * Seeds the generator and builds the zipf table, the distributions and
+ * their parameters must be set before this is called
+ */
+void workload_init(workload_t *workload, uint64_t seed)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        workload->state[i] = splitmix64(&seed);
+    }
+
+    workload->zipf_cdf = NULL;
+    if (workload->priority == PRIORITY_ZIPF && workload->priority_levels > 0)
+    {
+        workload->zipf_cdf = malloc(workload->priority_levels * sizeof(double));
+        if (workload->zipf_cdf == NULL)
+        {
+            perror("Unable to malloc zipf table");
+            exit(1);
+        }
+
+        double total = 0;
+        for (i = 0; i < workload->priority_levels; i++)
+        {
+            total += 1 / pow(i + 1, workload->zipf_s);
+            workload->zipf_cdf[i] = total;
+        }
+        for (i = 0; i < workload->priority_levels; i++)
+        {
+            workload->zipf_cdf[i] /= total;
+        }
+    }
+}
+
+void workload_free(workload_t *workload)
+{
+    free(workload->zipf_cdf);
+    workload->zipf_cdf = NULL;
+}
+
+/*
+ * Returns a uniform double in [0, 1) from the top 53 bits
+ */
+double workload_uniform(workload_t *workload)
+{
+    return (next_bits(workload) >> 11) * 0x1.0p-53;
+}
+
+/*
+ * Returns a standard normal deviate, Box-Muller
+ */
+static double normal(workload_t *workload)
+{
+    double u1 = 1 - workload_uniform(workload); // (0, 1], log is finite
+    double u2 = workload_uniform(workload);
+    return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+/*
+ * Returns the nanoseconds until the next arrival
+ */
+long long workload_interarrival(workload_t *workload)
+{
+    double seconds = workload->interarrival;
+    if (workload->arrival == ARRIVAL_EXPONENTIAL)
+        seconds = -workload->interarrival * log(1 - workload_uniform(workload));
+    return (long long)(seconds * 1e9);
+}
+
+/*
+ * Returns the next cpu burst in microseconds, always within min_burst and max_burst
+ */
+long long workload_burst(workload_t *workload)
+{
+    double low = workload->min_burst;
+    double high = workload->max_burst;
+    double u = workload_uniform(workload);
+    double seconds;
+
+    switch (workload->burst)
+    {
+    case BURST_PARETO:
+    {
+        // inverse cdf of the pareto truncated to [low, high], low is above zero
+        double alpha = workload->burst_shape;
+        seconds = low / pow(1 - u * (1 - pow(low / high, alpha)), 1 / alpha);
+        break;
+    }
+    case BURST_LOGNORMAL:
+    {
+        // centred on the geometric mean of the bounds, draws outside them are redrawn a few times then clamped
+        double mu = log(low > 0 ? sqrt(low * high) : high / 2);
+        int tries;
+        for (tries = 0; tries < 8; tries++)
+        {
+            seconds = exp(mu + workload->burst_shape * normal(workload));
+            if (seconds >= low && seconds <= high)
+                break;
+        }
+        break;
+    }
+    case BURST_UNIFORM:
+    default:
+        seconds = low + u * (high - low);
+        break;
+    }
+
+    if (seconds < low)
+        seconds = low;
+    if (seconds > high)
+        seconds = high;
+    return (long long)(seconds * 1e6 + 0.5);
+}
+
+/*
+ * Returns the next priority in 1..priority_levels, 1 if there are no levels
+ */
+int workload_priority(workload_t *workload)
+{
+    if (workload->priority_levels <= 1)
+        return 1;
+
+    double u = workload_uniform(workload);
+    if (workload->priority == PRIORITY_ZIPF)
+    {
+        // first level whose cumulative weight passes u
+        int low = 0;
+        int high = workload->priority_levels - 1;
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            if (workload->zipf_cdf[mid] > u)
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        return low + 1;
+    }
+    return (int)(u * workload->priority_levels) + 1;
+}
+
+/*
+ * Returns the next core count in 1..max_cpus, 0 if jobs float
+ */
+int workload_cpus(workload_t *workload)
+{
+    if (workload->max_cpus <= 0)
+        return 0;
+    return (int)(workload_uniform(workload) * workload->max_cpus) + 1;
+}
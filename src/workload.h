@@ -0,0 +1,70 @@
+/*
+ * COMP7500/7506
+ * Project 3: workload generator header
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Header file for the benchmark workload generator, used by test and simulate
+ *
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+
+#define DEFAULT_PARETO_ALPHA 1.5    /* tail index of bounded pareto bursts, smaller is heavier */
+#define DEFAULT_LOGNORMAL_SIGMA 1.0 /* spread of lognormal bursts around their median */
+#define DEFAULT_ZIPF_S 1.0          /* skew of zipf priorities, 0 is uniform */
+
+enum arrival_dist
+{
+    ARRIVAL_FIXED,       /* one job every interarrival seconds */
+    ARRIVAL_EXPONENTIAL, /* poisson arrivals, exponential gaps with mean interarrival */
+};
+
+enum burst_dist
+{
+    BURST_UNIFORM,   /* uniform between min_burst and max_burst */
+    BURST_PARETO,    /* bounded pareto between min_burst and max_burst */
+    BURST_LOGNORMAL, /* lognormal with median sqrt(min_burst * max_burst), kept within the bounds */
+};
+
+enum priority_dist
+{
+    PRIORITY_UNIFORM, /* uniform over 1..priority_levels */
+    PRIORITY_ZIPF,    /* priority k drawn with weight 1 / k^zipf_s */
+};
+
+typedef struct
+{
+    uint64_t state[4]; /* xoshiro256** state, never all zero */
+
+    enum arrival_dist arrival;
+    double interarrival; /* mean seconds between arrivals, 0 submits every job at once */
+
+    enum burst_dist burst;
+    double min_burst;   /* shortest burst in seconds */
+    double max_burst;   /* longest burst in seconds */
+    double burst_shape; /* pareto alpha or lognormal sigma */
+
+    enum priority_dist priority;
+    int priority_levels;
+    double zipf_s;
+    double *zipf_cdf; /* cumulative zipf weights, one per level */
+
+    int max_cpus; /* widest job in cores, jobs are uniform over 1..max_cpus, 0 for jobs that float */
+
+} workload_t;
+
+void workload_init(workload_t *workload, uint64_t seed); /* seeds the generator, set the distributions first */
+void workload_free(workload_t *workload);                /* frees the zipf table */
+double workload_uniform(workload_t *workload);           /* uniform double in [0, 1) */
+long long workload_interarrival(workload_t *workload);  /* nanoseconds until the next arrival */
+long long workload_burst(workload_t *workload);         /* next cpu burst in microseconds */
+int workload_priority(workload_t *workload);            /* next priority, 1..priority_levels */
+int workload_cpus(workload_t *workload);                /* next core count, 1..max_cpus, 0 without max_cpus */
+
+#endif
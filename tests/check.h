@@ -0,0 +1,43 @@
+/*
+ * COMP7500/7506
+ * Project 3: test helpers
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Shared by the tests make check runs. Each test includes the module it
+ * covers so static functions can be reached, CHECK counts every check and
+ * reports the failed ones without stopping the test
+ *
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int checks;   /* checks run so far */
+static int failures; /* checks that failed */
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        checks++;                                                                         \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            failures++;                                                                   \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                                 \
+    } while (0)
+
+/*
+ * Prints how many checks ran and failed, returns the exit status for main
+ */
+static inline int report_checks(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, checks, failures);
+    return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * COMP7500/7506
+ * Project 3: submission channel tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the bounded multi-producer submission channel, run by
+ * make check
+ *
+ */
+
+#include "check.h"
+#include "../src/channel.c"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define PRODUCERS 4
+#define PER_PRODUCER 200000
+
+/*
+ * The capacity rounds up to a power of two, values come out in order and a
+ * full channel refuses a push instead of waiting
+ */
+static void test_fifo()
+{
+    channel_t channel;
+    channel_init(&channel, 5);
+    CHECK(channel.mask == 7);
+    CHECK(channel_pop(&channel) == NULL);
+
+    uintptr_t i;
+    for (i = 1; i <= 8; i++)
+    {
+        CHECK(channel_push(&channel, (void *)i) == 0);
+    }
+    CHECK(channel_push(&channel, (void *)9) == -1);
+
+    for (i = 1; i <= 8; i++)
+    {
+        CHECK(channel_pop(&channel) == (void *)i);
+    }
+    CHECK(channel_pop(&channel) == NULL);
+
+    // many laps round the ring keep the order
+    int ordered = 1;
+    for (i = 1; i <= 1000; i++)
+    {
+        channel_push(&channel, (void *)(2 * i));
+        channel_push(&channel, (void *)(2 * i + 1));
+        ordered &= channel_pop(&channel) == (void *)(2 * i);
+        ordered &= channel_pop(&channel) == (void *)(2 * i + 1);
+    }
+    CHECK(ordered);
+    CHECK(channel_pop(&channel) == NULL);
+    free(channel.cells);
+}
+
+/*
+ * A batch is pushed whole or not at all
+ */
+static void test_push_many()
+{
+    channel_t channel;
+    channel_init(&channel, 8);
+    void *values[9];
+    uintptr_t i;
+    for (i = 0; i < 9; i++)
+    {
+        values[i] = (void *)(i + 1);
+    }
+
+    CHECK(channel_push_many(&channel, values, 0) == 0);
+    CHECK(channel_push_many(&channel, values, 9) == -1);
+    CHECK(channel_pop(&channel) == NULL);
+
+    CHECK(channel_push_many(&channel, values, 5) == 0);
+    CHECK(channel_push_many(&channel, values, 4) == -1); // only 3 cells are left
+    CHECK(channel_push_many(&channel, values, 3) == 0);
+    for (i = 0; i < 5; i++)
+    {
+        CHECK(channel_pop(&channel) == values[i]);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        CHECK(channel_pop(&channel) == values[i]);
+    }
+    CHECK(channel_pop(&channel) == NULL);
+
+    // a batch that wraps past the end of the ring
+    CHECK(channel_push_many(&channel, values, 8) == 0);
+    for (i = 0; i < 8; i++)
+    {
+        CHECK(channel_pop(&channel) == values[i]);
+    }
+    free(channel.cells);
+}
+
+static channel_t shared;
+
+/*
+ * Pushes PER_PRODUCER values tagged with the producer, retrying while full
+ */
+static void *producer(void *arg)
+{
+    uintptr_t id = (uintptr_t)arg;
+    uintptr_t i;
+    for (i = 1; i <= PER_PRODUCER; i++)
+    {
+        void *value = (void *)(id << 32 | i);
+        while (channel_push(&shared, value))
+            sched_yield();
+    }
+    return NULL;
+}
+
+/*
+ * Producers racing on a small channel lose nothing, and each one's values
+ * arrive in the order it pushed them
+ */
+static void test_producers()
+{
+    channel_init(&shared, 64);
+    pthread_t threads[PRODUCERS];
+    uintptr_t i;
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        pthread_create(&threads[i], NULL, producer, (void *)i);
+    }
+
+    uintptr_t next[PRODUCERS] = {0};
+    long long popped = 0;
+    int valid = 1;
+    while (popped < (long long)PRODUCERS * PER_PRODUCER)
+    {
+        void *value = channel_pop(&shared);
+        if (value == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        uintptr_t id = (uintptr_t)value >> 32;
+        uintptr_t sequence = (uintptr_t)value & 0xffffffff;
+        valid &= id < PRODUCERS && sequence == next[id] + 1;
+        if (id < PRODUCERS)
+            next[id] = sequence;
+        popped++;
+    }
+    CHECK(valid);
+
+    for (i = 0; i < PRODUCERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        CHECK(next[i] == PER_PRODUCER);
+    }
+    CHECK(channel_pop(&shared) == NULL);
+    free(shared.cells);
+}
+
+int main()
+{
+    test_fifo();
+    test_push_many();
+    test_producers();
+    return report_checks("test_channel");
+}
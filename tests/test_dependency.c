@@ -0,0 +1,216 @@
+/*
+ * COMP7500/7506
+ * Project 3: dependency tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for parsing run --after and for holding, releasing and
+ * cancelling the jobs that wait on other jobs, run by make check
+ *
+ */
+
+#include "check.h"
+#include "../src/dependency.c"
+
+static process_p jobs[5]; /* ids 0 and 1 finished before a restart, 2 to 4 are unfinished */
+
+/*
+ * Returns a job waiting on the n jobs in ids, ok for afterok
+ */
+static process_p make_waiting(const u_int *ids, const int *ok, int n)
+{
+    process_p process = new_process("./job", 1000000, 1);
+    process->after = malloc(n * sizeof(dependency_t));
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        process->after[i].id = ids[i];
+        process->after[i].ok = ok[i];
+    }
+    process->num_after = n;
+    return process;
+}
+
+/*
+ * The dependency options are stripped off the command line and other
+ * options are left alone, an id that was never submitted or whose exit
+ * status is gone is refused for afterok
+ */
+static void test_parse()
+{
+    dependency_t *after;
+    int num_after;
+    char *args[] = {"run", "--after", "2,3", "--afterany", "0", "--cpus", "2", "./job", "5", "1"};
+    int nargs = 10;
+    CHECK(parse_dependencies(&nargs, args, &after, &num_after) == NULL);
+    CHECK(nargs == 6);
+    CHECK(num_after == 3);
+    CHECK(after[0].id == 2 && after[0].ok);
+    CHECK(after[1].id == 3 && after[1].ok);
+    CHECK(after[2].id == 0 && !after[2].ok);
+    CHECK(!strcmp(args[1], "--cpus") && !strcmp(args[3], "./job") && !strcmp(args[5], "1"));
+    free(after);
+
+    char *afterok[] = {"run", "--afterok", "4", "./job", "5", "1"};
+    nargs = 6;
+    CHECK(parse_dependencies(&nargs, afterok, &after, &num_after) == NULL);
+    CHECK(nargs == 4 && num_after == 1 && after[0].id == 4 && after[0].ok);
+    free(after);
+
+    char *none[] = {"run", "./job", "5", "1"};
+    nargs = 4;
+    CHECK(parse_dependencies(&nargs, none, &after, &num_after) == NULL);
+    CHECK(nargs == 4 && after == NULL && num_after == 0);
+
+    // errors leave nothing behind
+    char *future[] = {"run", "--after", "2,99", "./job", "5", "1"};
+    char *unknown[] = {"run", "--after", "0", "./job", "5", "1"};
+    char *trailing[] = {"run", "--after", "2,", "./job", "5", "1"};
+    char *word[] = {"run", "--afterany", "two", "./job", "5", "1"};
+    char **bad[] = {future, unknown, trailing, word};
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        nargs = 6;
+        CHECK(parse_dependencies(&nargs, bad[i], &after, &num_after) != NULL);
+        CHECK(nargs == 6 && after == NULL && num_after == 0);
+    }
+
+    // afterany only needs the job to have finished
+    char *anyway[] = {"run", "--afterany", "0", "./job", "5", "1"};
+    nargs = 6;
+    CHECK(parse_dependencies(&nargs, anyway, &after, &num_after) == NULL);
+    CHECK(num_after == 1 && !after[0].ok);
+    free(after);
+}
+
+/*
+ * Jobs waiting on unfinished jobs are held and released or cancelled as
+ * those finish, a failure cancels everything below it with afterok
+ */
+static void test_release()
+{
+    // a job whose exit status was lost is not a success
+    process_p lost_ok = make_waiting((u_int[]){0}, (int[]){1}, 1);
+    process_p lost_any = make_waiting((u_int[]){1}, (int[]){0}, 1);
+    CHECK(hold_process(lost_ok) == DEPENDENCIES_FAILED);
+    CHECK(hold_process(lost_any) == DEPENDENCIES_MET);
+
+    process_p both = make_waiting((u_int[]){2, 3}, (int[]){1, 0}, 2);
+    process_p chained = make_waiting((u_int[]){both->id}, (int[]){1}, 1);
+    process_p any = make_waiting((u_int[]){2}, (int[]){0}, 1);
+    process_p success = make_waiting((u_int[]){4}, (int[]){1}, 1);
+    CHECK(hold_process(both) == DEPENDENCIES_PENDING);
+    CHECK(hold_process(chained) == DEPENDENCIES_PENDING);
+    CHECK(hold_process(any) == DEPENDENCIES_PENDING);
+    CHECK(hold_process(success) == DEPENDENCIES_PENDING);
+
+    u_int n;
+    process_p *held_list = held_jobs(&n);
+    CHECK(n == 4);
+    free(held_list);
+
+    // both still waits on job 2 after job 3 finishes
+    process_p ready = NULL;
+    process_p cancelled = NULL;
+    release_dependents(3, 0, &ready, &cancelled);
+    CHECK(ready == NULL && cancelled == NULL);
+
+    // job 2 failing cancels the afterok job and frees the afterany one
+    release_dependents(2, 1, &ready, &cancelled);
+    CHECK(ready == any && any->next == NULL);
+    CHECK(cancelled == both && both->next == NULL);
+
+    // cancelling a job cancels the jobs waiting on it in turn
+    ready = NULL;
+    cancelled = NULL;
+    release_dependents(both->id, JOB_CANCELLED, &ready, &cancelled);
+    CHECK(ready == NULL && cancelled == chained);
+
+    cancelled = NULL;
+    release_dependents(4, 0, &ready, &cancelled);
+    CHECK(ready == success && cancelled == NULL);
+
+    held_list = held_jobs(&n);
+    CHECK(n == 0);
+    free(held_list);
+
+    // a job nobody waits on has nothing to release, and once every job finishes the table is empty
+    ready = NULL;
+    cancelled = NULL;
+    release_dependents(chained->id, JOB_CANCELLED, &ready, &cancelled);
+    release_dependents(any->id, 0, &ready, &cancelled);
+    release_dependents(success->id, 0, &ready, &cancelled);
+    CHECK(ready == NULL && cancelled == NULL);
+    CHECK(num_nodes == 0);
+
+    process_p processes[] = {lost_ok, lost_any, both, chained, any, success};
+    int i;
+    for (i = 0; i < 6; i++)
+    {
+        free(processes[i]->after);
+        free(processes[i]);
+    }
+}
+
+/*
+ * Many jobs waiting on one job are all released by its finish, however
+ * large the table grows
+ */
+static void test_fan_out()
+{
+    int n = DEPENDENCY_BUCKETS * 3;
+    process_p *waiting = malloc(n * sizeof(process_p));
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        waiting[i] = make_waiting((u_int[]){4, i ? waiting[i - 1]->id : 4}, (int[]){1, 0}, i ? 2 : 1);
+        CHECK(hold_process(waiting[i]) == DEPENDENCIES_PENDING);
+    }
+    CHECK(num_buckets > DEPENDENCY_BUCKETS);
+
+    // each job also waits on the one before it, so they come free one at a time
+    process_p ready = NULL;
+    process_p cancelled = NULL;
+    release_dependents(4, 0, &ready, &cancelled);
+    int released = 0;
+    while (ready)
+    {
+        process_p process = ready;
+        ready = process->next;
+        released++;
+        release_dependents(process->id, 0, &ready, &cancelled);
+    }
+    CHECK(released == n);
+    CHECK(cancelled == NULL);
+    CHECK(num_held == 0 && num_nodes == 0);
+
+    for (i = 0; i < n; i++)
+    {
+        free(waiting[i]->after);
+        free(waiting[i]);
+    }
+    free(waiting);
+}
+
+int main()
+{
+    int i;
+    for (i = 0; i < 5; i++)
+    {
+        jobs[i] = new_process("./job", 1000000, 1);
+    }
+    restore_job_status(&jobs[2], 3);
+
+    test_parse();
+    test_release();
+    test_fan_out();
+
+    for (i = 0; i < 5; i++)
+    {
+        free(jobs[i]);
+    }
+    return report_checks("test_dependency");
+}
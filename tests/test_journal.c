@@ -0,0 +1,331 @@
+/*
+ * COMP7500/7506
+ * Project 3: journal tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for replaying the write ahead journal, ignoring a torn
+ * tail, keeping dependencies, and folding the journal into a snapshot, run
+ * by make check
+ *
+ */
+
+#include "check.h"
+#include "../src/journal.c"
+
+static char directory[] = "/tmp/test_journalXXXXXX";
+
+/*
+ * Builds a record for a job without a placement, see build_record
+ */
+static size_t make_record(char *out, u_int type, u_int id, long long value, int priority, const char *cmd)
+{
+    return build_record(out, type, id, value, 1000 + id, priority, 0, cmd);
+}
+
+/*
+ * Empties the table of unfinished jobs
+ */
+static void reset_table()
+{
+    u_int i;
+    for (i = 0; i < num_buckets; i++)
+    {
+        while (buckets[i])
+            remove_job(buckets[i]->id);
+    }
+    free(buckets);
+    buckets = NULL;
+    num_buckets = 0;
+    grow_table();
+}
+
+/*
+ * Writes size bytes of records to path
+ */
+static void write_file(const char *path, const char *records, size_t size)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    write_all(fd, records, size);
+    close(fd);
+}
+
+/*
+ * Applying a record twice leaves the table as applying it once, and the
+ * table keeps every job as it grows
+ */
+static void test_table()
+{
+    reset_table();
+    _Alignas(journal_record_t) char record[RECORD_MAX];
+    journal_record_t *view = (journal_record_t *)record;
+
+    CHECK(make_record(record, JOURNAL_SUBMIT, 7, 2500000, 3, "./process 2") == RECORD_HEADER + strlen("./process 2") + 1);
+    CHECK(view->checksum == checksum(&view->type, view->size - offsetof(journal_record_t, type)));
+    apply_record(view);
+    apply_record(view);
+    CHECK(num_jobs == 1);
+    journal_job_t *job = *find_job(7);
+    CHECK(job && job->cpu_burst == 2500000 && job->priority == 3 && job->arrival_time == 1007);
+    CHECK(job && !strcmp(job->cmd, "./process 2") && job->pid == 0);
+
+    make_record(record, JOURNAL_START, 7, 4242, 0, NULL);
+    CHECK(view->size == RECORD_HEADER);
+    apply_record(view);
+    CHECK(job->pid == 4242);
+
+    make_record(record, JOURNAL_FINISH, 7, 0, 0, NULL);
+    apply_record(view);
+    apply_record(view);
+    CHECK(num_jobs == 0);
+    CHECK(*find_job(7) == NULL);
+
+    // a start or finish for a job the table never saw is ignored
+    make_record(record, JOURNAL_START, 8, 1, 0, NULL);
+    apply_record(view);
+    CHECK(num_jobs == 0);
+
+    u_int id;
+    u_int jobs = JOURNAL_BUCKETS * 5;
+    for (id = 0; id < jobs; id++)
+    {
+        make_record(record, JOURNAL_SUBMIT, id, id, 1, "./job");
+        apply_record(view);
+    }
+    CHECK(num_jobs == jobs);
+    CHECK(num_buckets > JOURNAL_BUCKETS);
+    int found = 1;
+    for (id = 0; id < jobs; id++)
+    {
+        job = *find_job(id);
+        found &= job && job->cpu_burst == id;
+    }
+    CHECK(found);
+    reset_table();
+}
+
+/*
+ * Replay stops at a torn or corrupt record, which can only be the last
+ * write before a crash, and keeps everything before it
+ */
+static void test_recovery()
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/torn", directory);
+    char *records = malloc(RECORD_MAX * 8);
+    size_t size = 0;
+    size += make_record(records + size, JOURNAL_EPOCH, 3, 10, 0, NULL);
+    size += make_record(records + size, JOURNAL_SUBMIT, 10, 100, 1, "./a");
+    size += make_record(records + size, JOURNAL_SUBMIT, 11, 200, 2, "./b");
+    size += make_record(records + size, JOURNAL_START, 10, 99, 0, NULL);
+    size += make_record(records + size, JOURNAL_SUBMIT, 12, 300, 3, "./c");
+    size += make_record(records + size, JOURNAL_FINISH, 11, 0, 0, NULL);
+    size += make_record(records + size, JOURNAL_SUBMIT, 13, 400, 4, "./d");
+
+    // the last submit lost its final bytes
+    reset_table();
+    write_file(path, records, size - 3);
+    u_int file_epoch = 0;
+    u_int next = 0;
+    CHECK(load_file(path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(file_epoch == 3);
+    CHECK(next == 13);
+    CHECK(num_jobs == 2);
+    CHECK(*find_job(10) && (*find_job(10))->pid == 99);
+    CHECK(*find_job(11) == NULL);
+    CHECK(*find_job(12) && !strcmp((*find_job(12))->cmd, "./c"));
+    CHECK(*find_job(13) == NULL);
+
+    // a flipped byte in the last submit fails its checksum
+    reset_table();
+    records[size - 2] ^= 1;
+    write_file(path, records, size);
+    next = 0;
+    CHECK(load_file(path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(num_jobs == 2 && *find_job(13) == NULL);
+    records[size - 2] ^= 1;
+
+    // intact, every record is applied
+    reset_table();
+    write_file(path, records, size);
+    next = 0;
+    CHECK(load_file(path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(num_jobs == 3 && next == 14);
+
+    // a journal from an older epoch is ignored, the matching one is read
+    reset_table();
+    CHECK(load_file(path, &file_epoch, &next, 2, 1) == 0);
+    CHECK(num_jobs == 0);
+    CHECK(load_file(path, &file_epoch, &next, 3, 1) == 0);
+    CHECK(num_jobs == 3);
+
+    // a file that does not start with an epoch is not a journal
+    reset_table();
+    write_file(path, records + RECORD_HEADER, size - RECORD_HEADER);
+    CHECK(load_file(path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(num_jobs == 0);
+
+    snprintf(path, sizeof(path), "%s/missing", directory);
+    CHECK(load_file(path, &file_epoch, &next, 0, 0) == -1);
+
+    free(records);
+    reset_table();
+}
+
+/*
+ * Compaction writes the unfinished jobs to a snapshot in the next epoch and
+ * restarts the journal empty, reading both back gives the same table
+ */
+static void test_compact()
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/journal", directory);
+    journal_path = strdup(path);
+    snapshot_path = malloc(strlen(path) + strlen(SNAPSHOT_SUFFIX) + 1);
+    sprintf(snapshot_path, "%s%s", path, SNAPSHOT_SUFFIX);
+
+    reset_table();
+    epoch = 4;
+    next_id = 600;
+    pthread_mutex_lock(&journal_lock);
+    u_int id;
+    for (id = 1; id <= 500; id++)
+    {
+        append_record(JOURNAL_SUBMIT, id, id * 10, 1000 + id, id % 7, id, "./process");
+        if (id % 3 == 0)
+            append_record(JOURNAL_START, id, 20000 + id, 0, 0, 0, NULL);
+        if (id % 5 == 0)
+            append_record(JOURNAL_FINISH, id, 0, 0, 0, 0, NULL);
+    }
+    CHECK(num_jobs == 400);
+    CHECK(pending_len > 0);
+    compact();
+    pthread_mutex_unlock(&journal_lock);
+
+    CHECK(epoch == 5);
+    CHECK(pending_len == 0);
+    CHECK(journal_fd >= 0);
+    struct stat info;
+    CHECK(stat(journal_path, &info) == 0 && info.st_size == RECORD_HEADER);
+
+    reset_table();
+    u_int file_epoch = 0;
+    u_int next = 0;
+    CHECK(load_file(snapshot_path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(file_epoch == 5 && next == 600);
+    CHECK(load_file(journal_path, &file_epoch, &next, file_epoch, 1) == 0);
+    CHECK(num_jobs == 400);
+    int same = 1;
+    for (id = 1; id <= 500; id++)
+    {
+        journal_job_t *job = *find_job(id);
+        if (id % 5 == 0)
+            same &= job == NULL;
+        else
+            same &= job && job->cpu_burst == id * 10 && job->priority == id % 7 &&
+                    job->arrival_time == 1000 + id && job->placement == id && job->pid == (id % 3 ? 0 : 20000 + id);
+    }
+    CHECK(same);
+
+    // the old epoch's journal is what a crash between the two renames leaves, it is ignored
+    reset_table();
+    CHECK(load_file(journal_path, &file_epoch, &next, 4, 1) == 0);
+    CHECK(num_jobs == 0);
+
+    close(journal_fd);
+    journal_fd = -1;
+    unlink(journal_path);
+    unlink(snapshot_path);
+    free(journal_path);
+    free(snapshot_path);
+    reset_table();
+}
+
+/*
+ * A failed afterok stays on the job so recovery cancels it, a met
+ * dependency is dropped, and both survive compaction
+ */
+static void test_dependencies()
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/after", directory);
+    journal_path = strdup(path);
+    snapshot_path = malloc(strlen(path) + strlen(SNAPSHOT_SUFFIX) + 1);
+    sprintf(snapshot_path, "%s%s", path, SNAPSHOT_SUFFIX);
+
+    reset_table();
+    pthread_mutex_lock(&journal_lock);
+    append_record(JOURNAL_SUBMIT, 1, 10, 0, 1, 0, "./first");
+    append_record(JOURNAL_SUBMIT, 2, 10, 0, 1, 0, "./needs_success");
+    append_record(JOURNAL_AFTER, 2, 1, 0, 1, 0, NULL);
+    append_record(JOURNAL_SUBMIT, 3, 10, 0, 1, 0, "./needs_finish");
+    append_record(JOURNAL_AFTER, 3, 1, 0, 0, 0, NULL);
+    CHECK((*find_job(1))->num_dependents == 2);
+
+    // afterany on a job that already finished is met, afterok on one that failed is not
+    append_record(JOURNAL_AFTER, 3, 99, 0, 0, 0, NULL);
+    append_record(JOURNAL_AFTER, 2, 98, 0, 1, 0, NULL);
+    CHECK((*find_job(3))->num_after == 1);
+    CHECK((*find_job(2))->num_after == 2);
+
+    append_record(JOURNAL_FINISH, 1, 1, 0, 0, 0, NULL);
+    CHECK(*find_job(1) == NULL);
+    CHECK((*find_job(3))->num_after == 0);
+    journal_job_t *job = *find_job(2);
+    CHECK(job->num_after == 2);
+    CHECK(job->after[0].id == 1 && job->after[0].ok);
+    CHECK(job->after[1].id == 98 && job->after[1].ok);
+    compact();
+    pthread_mutex_unlock(&journal_lock);
+
+    reset_table();
+    u_int file_epoch = 0;
+    u_int next = 0;
+    CHECK(load_file(snapshot_path, &file_epoch, &next, 0, 0) == 0);
+    CHECK(num_jobs == 2);
+    job = *find_job(2);
+    CHECK(job && job->num_after == 2);
+    CHECK(job && job->after[0].id == 1 && job->after[0].ok && job->after[1].id == 98);
+    CHECK(*find_job(3) && (*find_job(3))->num_after == 0);
+
+    close(journal_fd);
+    journal_fd = -1;
+    unlink(journal_path);
+    unlink(snapshot_path);
+    free(journal_path);
+    free(snapshot_path);
+    reset_table();
+}
+
+/*
+ * Without a journal submitting never waits
+ */
+static void test_off()
+{
+    CHECK(journal_submit(NULL, 0) == 0);
+    journal_sync(1);
+    journal_finish(1, 0);
+    CHECK(num_jobs == 0);
+}
+
+int main()
+{
+    if (mkdtemp(directory) == NULL)
+    {
+        perror("Unable to create test directory");
+        return 1;
+    }
+    test_table();
+    test_recovery();
+    test_compact();
+    test_dependencies();
+    test_off();
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/torn", directory);
+    unlink(path);
+    rmdir(directory);
+    return report_checks("test_journal");
+}
@@ -0,0 +1,165 @@
+/*
+ * COMP7500/7506
+ * Project 3: metrics tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the streaming aggregates and the log bucketed
+ * histograms behind the reported percentiles, run by make check
+ *
+ */
+
+#include "check.h"
+#include "../src/metrics.c"
+
+/*
+ * Returns 1 if a and b differ by at most tolerance of b
+ */
+static int close_to(double a, double b, double tolerance)
+{
+    return fabs(a - b) <= tolerance * fabs(b);
+}
+
+/*
+ * Small values get a bucket each, larger ones land in a bucket whose bounds
+ * hold them and are at most 1/HIST_SUB_BUCKETS of the value wide
+ */
+static void test_buckets()
+{
+    long long value;
+    for (value = 0; value < HIST_SUB_BUCKETS; value++)
+    {
+        CHECK(hist_bucket(value) == value);
+        CHECK(hist_upper(value) == value);
+    }
+    CHECK(hist_bucket(-5) == 0);
+
+    u_int last = hist_bucket(HIST_SUB_BUCKETS - 1);
+    for (value = HIST_SUB_BUCKETS; value < (1LL << 20); value += value / 97 + 1)
+    {
+        u_int bucket = hist_bucket(value);
+        CHECK(bucket >= last);
+        CHECK(hist_upper(bucket) >= value);
+        CHECK(hist_upper(bucket - 1) < value);
+        CHECK(hist_upper(bucket) - hist_upper(bucket - 1) <= value / HIST_SUB_BUCKETS + 1);
+        last = bucket;
+    }
+
+    // every power of two starts a new bucket
+    int bits;
+    for (bits = HIST_SUB_BITS; bits < HIST_MAX_BITS; bits++)
+    {
+        CHECK(hist_bucket(1LL << bits) == hist_bucket((1LL << bits) - 1) + 1);
+    }
+
+    CHECK(hist_bucket(1LL << (HIST_MAX_BITS + 2)) == HIST_BUCKETS - 1);
+    CHECK(hist_bucket(LLONG_MAX) == HIST_BUCKETS - 1);
+}
+
+/*
+ * Percentiles of 1..10000 come out within the bucket precision, an empty
+ * histogram reports 0
+ */
+static void test_percentiles()
+{
+    histogram_t *hist = calloc(1, sizeof(histogram_t));
+    CHECK(hist_percentile(hist, 50) == 0);
+
+    long long value;
+    for (value = 1; value <= 10000; value++)
+    {
+        hist_add(hist, value);
+    }
+
+    double precision = 1.0 / HIST_SUB_BUCKETS;
+    CHECK(close_to(hist_percentile(hist, 50), 5000, precision));
+    CHECK(close_to(hist_percentile(hist, 90), 9000, precision));
+    CHECK(close_to(hist_percentile(hist, 99), 9900, precision));
+    CHECK(hist_percentile(hist, 50) >= 5000);
+    CHECK(hist_percentile(hist, 100) >= 10000);
+    CHECK(hist_percentile(hist, 0) == 1);
+    free(hist);
+}
+
+/*
+ * Merging two halves gives the same counts as adding everything to one
+ */
+static void test_hist_merge()
+{
+    histogram_t *whole = calloc(1, sizeof(histogram_t));
+    histogram_t *low = calloc(1, sizeof(histogram_t));
+    histogram_t *high = calloc(1, sizeof(histogram_t));
+
+    long long value;
+    for (value = 0; value < 5000; value += 3)
+    {
+        hist_add(whole, value * value);
+        hist_add(value < 2500 ? low : high, value * value);
+    }
+    hist_merge(low, high);
+    CHECK(!memcmp(low, whole, sizeof(histogram_t)));
+    free(whole);
+    free(low);
+    free(high);
+}
+
+/*
+ * The running mean and variance match the textbook values, and merged
+ * stats match one stat fed every value
+ */
+static void test_stats()
+{
+    stat_t whole, odd, even;
+    memset(&whole, 0, sizeof(whole));
+    memset(&odd, 0, sizeof(odd));
+    memset(&even, 0, sizeof(even));
+    CHECK(stat_mean(&whole) == 0);
+    CHECK(stat_stddev(&whole) == 0);
+
+    // 2 4 4 4 5 5 7 9 has mean 5 and standard deviation 2
+    long long values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+    u_int i;
+    for (i = 0; i < 8; i++)
+    {
+        stat_add(&whole, values[i]);
+        stat_add(i % 2 ? &odd : &even, values[i]);
+    }
+    CHECK(stat_mean(&whole) == 5);
+    CHECK(close_to(stat_stddev(&whole), 2, 1e-12));
+    CHECK(load(&whole.min) == 2 && load(&whole.max) == 9);
+
+    stat_t merged;
+    memset(&merged, 0, sizeof(merged));
+    stat_merge(&merged, &odd);
+    stat_merge(&merged, &even);
+    CHECK(load(&merged.count) == 8);
+    CHECK(load(&merged.min) == 2 && load(&merged.max) == 9);
+    CHECK(close_to(stat_mean(&merged), 5, 1e-12));
+    CHECK(close_to(stat_stddev(&merged), 2, 1e-12));
+}
+
+/*
+ * A series percentile never reports more than the largest value seen
+ */
+static void test_series_cap()
+{
+    series_t *series = calloc(1, sizeof(series_t));
+    series_add(series, 1000);
+    series_add(series, 1001);
+    CHECK(hist_percentile(&series->hist, 100) > 1001);
+    CHECK(series_percentile(series, 100) == 1001);
+    free(series);
+}
+
+int main()
+{
+    test_buckets();
+    test_percentiles();
+    test_hist_merge();
+    test_stats();
+    test_series_cap();
+
+    return report_checks("test_metrics");
+}
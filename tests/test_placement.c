@@ -0,0 +1,223 @@
+/*
+ * COMP7500/7506
+ * Project 3: placement tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the core reservation and the EASY backfill shadow
+ * time, on a made up machine of two four core nodes, run by make check
+ *
+ */
+
+#define _GNU_SOURCE /* before check.h pulls in stdio, placement.c needs cpu_set_t */
+
+#include "check.h"
+#include "../src/placement.c"
+
+#define SECOND 1000000LL /* cpu bursts are in microseconds */
+
+/*
+ * Forgets every claim and parked job and gives the placement two nodes of
+ * four free cores
+ */
+static void set_machine()
+{
+    int node;
+    num_nodes = 2;
+    for (node = 0; node < num_nodes; node++)
+    {
+        CPU_ZERO(&nodes[node].cpus);
+        int cpu;
+        for (cpu = node * 4; cpu < node * 4 + 4; cpu++)
+        {
+            CPU_SET(cpu, &nodes[node].cpus);
+        }
+        nodes[node].free = nodes[node].cpus;
+        nodes[node].num_cpus = 4;
+        nodes[node].num_free = 4;
+    }
+    total_cpus = 8;
+    free_total = 8;
+    claims = NULL;
+    num_claims = 0;
+    parked = NULL;
+    reserved = NULL;
+    reserved_width = 0;
+}
+
+/*
+ * Returns a job asking for cpus cores that declares a burst of seconds
+ */
+static process_p make_job(int cpus, long long seconds)
+{
+    process_p process = new_process("./job", seconds * SECOND, 1);
+    process->placement.cpus = cpus;
+    return process;
+}
+
+/*
+ * Claims cores for process, returns 1 if it started
+ */
+static int start(process_p process)
+{
+    process_p requeue;
+    return claim_cpus(process, &requeue) == 0;
+}
+
+/*
+ * Returns the number of jobs in a list linked through next
+ */
+static int list_length(process_p list)
+{
+    int n = 0;
+    for (; list; list = list->next)
+        n++;
+    return n;
+}
+
+/*
+ * A job that does not fit holds the reservation, and the shadow time is when
+ * enough running jobs will have exited to give it its cores
+ */
+static void test_shadow()
+{
+    set_machine();
+    policy = BACKFILL;
+    process_p wide = make_job(6, 100);
+    process_p narrow = make_job(1, 10);
+    CHECK(start(wide));
+    CHECK(start(narrow));
+    CHECK(free_total == 1);
+
+    process_p reserved_job = make_job(4, 50);
+    process_p requeue;
+    CHECK(claim_cpus(reserved_job, &requeue) == -1);
+    CHECK(requeue == NULL);
+    CHECK(reserved == reserved_job && reserved_width == 4);
+    CHECK(parked == reserved_job);
+
+    // the narrow job's exit leaves 2 cores, the wide job's leaves 8, the reservation needs 4
+    long long now = now_ns();
+    long long shadow;
+    int extra;
+    find_shadow(now, &shadow, &extra);
+    CHECK(shadow == ((struct claim *)wide->claim)->end_ns);
+    CHECK(extra == 4);
+
+    // a job past its declared burst is expected to exit now
+    find_shadow(now + 1000 * SECOND * 1000, &shadow, &extra);
+    CHECK(shadow == now + 1000 * SECOND * 1000);
+
+    // with enough free cores there is nothing to wait for
+    free_total = 4;
+    find_shadow(now, &shadow, &extra);
+    CHECK(shadow == now && extra == 0);
+    free_total = 1;
+
+    // a long job using only cores the reservation will not need starts now
+    process_p spare = make_job(1, 1000);
+    CHECK(start(spare));
+}
+
+/*
+ * Under backfill a later job starts early if it exits before the shadow
+ * time or fits in the cores left over once the reserved job starts, and
+ * waits otherwise. Any other policy keeps every later job waiting
+ */
+static void test_backfill()
+{
+    set_machine();
+    policy = BACKFILL;
+    process_p half = make_job(4, 100);
+    CHECK(start(half));
+    process_p whole = make_job(8, 10);
+    CHECK(!start(whole));
+    CHECK(reserved == whole);
+
+    // the reservation needs every core, so only jobs that end before the shadow may run
+    process_p late = make_job(2, 200);
+    process_p early = make_job(2, 50);
+    CHECK(!start(late));
+    CHECK(reserved == whole);
+    CHECK(start(early));
+    CHECK(free_total == 2);
+
+    // a job that floats is charged one core
+    process_p floating = make_job(0, 20);
+    CHECK(start(floating));
+    CHECK(free_total == 1);
+    CHECK(((struct claim *)floating->claim)->width == 1);
+
+    // every parked job comes back oldest first when cores are freed
+    process_p waiting = release_cpus(early);
+    CHECK(list_length(waiting) == 2);
+    CHECK(waiting == whole && waiting->next == late);
+    CHECK(free_total == 3);
+    CHECK(reserved == whole);
+
+    // the reserved job starts once the running jobs exit and gives up the reservation
+    CHECK(!start(whole));
+    CHECK(release_cpus(floating) == whole);
+    CHECK(release_cpus(half) == NULL);
+    process_p requeue;
+    CHECK(claim_cpus(whole, &requeue) == 0);
+    CHECK(reserved == NULL && requeue == NULL);
+    CHECK(free_total == 0);
+    release_cpus(whole);
+    CHECK(free_total == 8 && num_claims == 0);
+    CHECK(nodes[0].num_free == 4 && nodes[1].num_free == 4);
+
+    // first come first served never lets a later job pass the reserved one
+    set_machine();
+    policy = FCFS;
+    half = make_job(4, 100);
+    CHECK(start(half));
+    whole = make_job(8, 10);
+    CHECK(!start(whole));
+    early = make_job(2, 1);
+    CHECK(!start(early));
+    CHECK(free_total == 4);
+}
+
+/*
+ * A job ahead of the reserved one in policy order takes the reservation
+ * over, and the jobs parked behind the old one come back to try again
+ */
+static void test_reservation_moves()
+{
+    set_machine();
+    policy = BACKFILL;
+    process_p first = make_job(8, 10);
+    process_p second = make_job(8, 10);
+    process_p third = make_job(6, 10);
+    CHECK(start(make_job(4, 100)));
+
+    process_p requeue;
+    CHECK(claim_cpus(second, &requeue) == -1);
+    CHECK(reserved == second);
+    CHECK(claim_cpus(third, &requeue) == -1);
+    CHECK(requeue == NULL);
+    CHECK(claim_cpus(first, &requeue) == -1);
+    CHECK(reserved == first && reserved_width == 8);
+    CHECK(list_length(requeue) == 2 && requeue == second);
+    CHECK(parked == first && first->next == NULL);
+
+    CHECK(drop_reservation(second) == NULL);
+    CHECK(drop_reservation(first) == first);
+    CHECK(reserved == NULL);
+
+    CHECK(claim_cpus(first, &requeue) == -1);
+    CHECK(reserved == first);
+    CHECK(reset_reservation() == first);
+    CHECK(reserved == NULL && parked == NULL);
+}
+
+int main()
+{
+    test_shadow();
+    test_backfill();
+    test_reservation_moves();
+    return report_checks("test_placement");
+}
@@ -0,0 +1,212 @@
+/*
+ * COMP7500/7506
+ * Project 3: ready queue tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the ready queue, run by make check. queue.c is
+ * included so the heap itself can be checked, not just what comes out of it
+ *
+ */
+
+#include "check.h"
+#include "../src/queue.c"
+
+/*
+ * Orders by id, like fcfs orders by submission
+ */
+static int by_id(const void *a, const void *b)
+{
+    process_p process_a = *(process_p *)a;
+    process_p process_b = *(process_p *)b;
+    return (process_a->id > process_b->id) - (process_a->id < process_b->id);
+}
+
+/*
+ * Orders by priority, highest first, then by id
+ */
+static int by_priority(const void *a, const void *b)
+{
+    process_p process_a = *(process_p *)a;
+    process_p process_b = *(process_p *)b;
+    if (process_a->priority != process_b->priority)
+        return process_b->priority - process_a->priority;
+    return by_id(a, b);
+}
+
+/*
+ * Returns 1 if no process in the heap comes before its parent
+ */
+static int heap_ordered(ready_queue_t *rq)
+{
+    u_int i;
+    for (i = 1; i < rq->size; i++)
+    {
+        if (rq->compare(&rq->heap[i], &rq->heap[(i - 1) / 2]) < 0)
+            return 0;
+    }
+    return 1;
+}
+
+static process_p make_process(u_int id, int priority)
+{
+    process_p process = calloc(1, sizeof(process_t));
+    if (process == NULL)
+    {
+        perror("Unable to malloc process");
+        exit(1);
+    }
+    process->id = id;
+    process->priority = priority;
+    return process;
+}
+
+/*
+ * An empty queue has nothing to peek at or pop
+ */
+static void test_empty()
+{
+    ready_queue_t rq;
+    rq_init(&rq, by_id);
+    CHECK(rq.size == 0);
+    CHECK(rq_peek(&rq) == NULL);
+    CHECK(rq_pop(&rq) == NULL);
+    free(rq.heap);
+}
+
+/*
+ * Processes pushed in a scrambled order come out in policy order, and the
+ * heap grows past its initial size without losing any
+ */
+static void test_order_and_growth()
+{
+    const u_int n = RQ_INITIAL_SIZE * 8 + 3;
+    ready_queue_t rq;
+    rq_init(&rq, by_id);
+
+    u_int i;
+    for (i = 0; i < n; i++)
+    {
+        // 37 is coprime with n, so every id is pushed exactly once
+        rq_push(&rq, make_process(i * 37 % n, 0));
+        CHECK(heap_ordered(&rq));
+    }
+    CHECK(rq.size == n);
+    CHECK(rq.capacity >= n);
+
+    for (i = 0; i < n; i++)
+    {
+        CHECK(rq_peek(&rq)->id == i);
+        process_p process = rq_pop(&rq);
+        CHECK(process->id == i);
+        CHECK(heap_ordered(&rq));
+        free(process);
+    }
+    CHECK(rq_pop(&rq) == NULL);
+    free(rq.heap);
+}
+
+/*
+ * Reordering for a new policy keeps every process and pops them in the new
+ * order, equal priorities still in submission order
+ */
+static void test_reorder()
+{
+    const u_int n = 100;
+    ready_queue_t rq;
+    rq_init(&rq, by_id);
+
+    u_int i;
+    for (i = 0; i < n; i++)
+    {
+        rq_push(&rq, make_process(i, i % 5));
+    }
+    rq_reorder(&rq, by_priority, 0);
+    CHECK(heap_ordered(&rq));
+    CHECK(rq.size == n);
+
+    process_p last = NULL;
+    for (i = 0; i < n; i++)
+    {
+        process_p process = rq_pop(&rq);
+        if (last)
+            CHECK(by_priority(&last, &process) < 0);
+        free(last);
+        last = process;
+    }
+    CHECK(last->priority == 0 && last->id == n - 5);
+    free(last);
+    free(rq.heap);
+}
+
+/*
+ * With feedback levels every level is a fifo, higher levels go first and a
+ * level past the last one is clamped to it. Going back to a heap keeps
+ * every process
+ */
+static void test_levels()
+{
+    const u_int n = 60;
+    ready_queue_t rq;
+    rq_init(&rq, by_id);
+
+    u_int i;
+    for (i = 0; i < n / 2; i++)
+    {
+        process_p process = make_process(i, 0);
+        process->level = i % 5;
+        rq_push(&rq, process);
+    }
+
+    // the waiting processes are sorted by compare into their levels
+    rq_reorder(&rq, by_id, 3);
+    CHECK(rq.num_levels == 3);
+    for (; i < n; i++)
+    {
+        process_p process = make_process(i, 0);
+        process->level = i % 5;
+        rq_push(&rq, process);
+    }
+    CHECK(rq.size == n);
+
+    process_p snapshot[60];
+    CHECK(rq_snapshot(&rq, snapshot) == n);
+    CHECK(snapshot[0] == rq_peek(&rq));
+
+    u_int level = 0;
+    process_p last = NULL;
+    for (i = 0; i < n / 2; i++)
+    {
+        process_p process = rq_pop(&rq);
+        CHECK(process == snapshot[i]);
+        CHECK(process->level >= level && process->level < 3);
+        if (last && process->level == level)
+            CHECK(process->id > last->id);
+        level = process->level;
+        last = process;
+        free(process);
+    }
+
+    rq_reorder(&rq, by_priority, 0);
+    CHECK(rq.num_levels == 0 && rq.levels == NULL);
+    CHECK(rq.size == n / 2);
+    CHECK(heap_ordered(&rq));
+    for (i = 0; i < n / 2; i++)
+    {
+        free(rq_pop(&rq));
+    }
+    CHECK(rq_pop(&rq) == NULL);
+    free(rq.heap);
+}
+
+int main()
+{
+    test_empty();
+    test_order_and_growth();
+    test_reorder();
+    test_levels();
+
+    return report_checks("test_queue");
+}
@@ -0,0 +1,158 @@
+/*
+ * COMP7500/7506
+ * Project 3: trace replay tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the standard workload format and csv trace parsers,
+ * run by make check
+ *
+ */
+
+#include "check.h"
+#include "../src/trace.c"
+
+/*
+ * Writes contents to a temporary file ending in suffix, path gets its name
+ */
+static void write_trace(char *path, const char *suffix, const char *contents)
+{
+    sprintf(path, "/tmp/test_traceXXXXXX%s", suffix);
+    int fd = mkstemps(path, strlen(suffix));
+    FILE *file = fdopen(fd, "w");
+    fputs(contents, file);
+    fclose(file);
+}
+
+/*
+ * Standard workload format lines give submit time, run time and queue
+ */
+static void test_swf_line()
+{
+    trace_job_t job;
+    char full[] = "1 10 3 25.5 4 -1 -1 4 30 -1 1 7 1 -1 2 -1 -1 -1\n";
+    CHECK(parse_swf(full, &job));
+    CHECK(job.submit == 10);
+    CHECK(job.runtime == 25.5);
+    CHECK(job.priority == 2);
+    CHECK(!strcmp(job.cmd, TRACE_DEFAULT_CMD));
+
+    // without a queue number the job gets priority 1, and so does an unknown queue
+    char short_line[] = "2\t12\t0\t3\n";
+    CHECK(parse_swf(short_line, &job));
+    CHECK(job.submit == 12 && job.runtime == 3 && job.priority == 1);
+    char unknown[] = "3 14 0 3 1 -1 -1 1 5 -1 1 1 1 -1 -1 -1 -1 -1\n";
+    CHECK(parse_swf(unknown, &job));
+    CHECK(job.priority == 1);
+
+    // cancelled jobs have no run time, and a line needs four fields
+    char cancelled[] = "4 16 0 -1 1 -1 -1 1 5 -1 5 1 1 -1 1 -1 -1 -1\n";
+    CHECK(!parse_swf(cancelled, &job));
+    char truncated[] = "5 18 0\n";
+    CHECK(!parse_swf(truncated, &job));
+}
+
+/*
+ * Csv lines give submit time, run time, priority and an optional command
+ */
+static void test_csv_line()
+{
+    trace_job_t job;
+    char plain[] = "1.5,2.25,3\n";
+    CHECK(parse_csv(plain, &job));
+    CHECK(job.submit == 1.5 && job.runtime == 2.25 && job.priority == 3);
+    CHECK(!strcmp(job.cmd, TRACE_DEFAULT_CMD));
+
+    char command[] = "4,1,2,  ./process 1 2  \r\n";
+    CHECK(parse_csv(command, &job));
+    CHECK(!strcmp(job.cmd, "./process 1 2"));
+
+    // an empty command falls back to the default
+    char empty[] = "4,1,2, \n";
+    CHECK(parse_csv(empty, &job));
+    CHECK(!strcmp(job.cmd, TRACE_DEFAULT_CMD));
+
+    char header[] = "submit_time,runtime,priority,command\n";
+    CHECK(!parse_csv(header, &job));
+    char negative[] = "1,-2,3\n";
+    CHECK(!parse_csv(negative, &job));
+    char missing[] = "1,2\n";
+    CHECK(!parse_csv(missing, &job));
+    char no_priority[] = "1,2,x\n";
+    CHECK(!parse_csv(no_priority, &job));
+}
+
+/*
+ * A whole swf trace streams its jobs in order, skipping comments, blank
+ * lines and jobs that cannot be replayed
+ */
+static void test_swf_file()
+{
+    char path[64];
+    write_trace(path, ".swf",
+                "; Version: 2.2\n"
+                ";   a comment\n"
+                "\n"
+                "1 0 1 5 1 -1 -1 1 10 -1 1 1 1 -1 1 -1 -1 -1\n"
+                "2 3 1 -1 1 -1 -1 1 10 -1 5 1 1 -1 1 -1 -1 -1\n"
+                "   3 7 0 2 1 -1 -1 1 10 -1 1 1 1 -1 4 -1 -1 -1\n");
+
+    trace_t trace;
+    trace_job_t job;
+    CHECK(trace_open(&trace, path) == 0);
+    CHECK(!trace.csv);
+    CHECK(trace_next(&trace, &job));
+    CHECK(job.submit == 0 && job.runtime == 5 && job.priority == 1);
+    CHECK(trace_next(&trace, &job));
+    CHECK(job.submit == 7 && job.runtime == 2 && job.priority == 4);
+    CHECK(trace.line == 6);
+    CHECK(!trace_next(&trace, &job));
+    trace_close(&trace);
+    unlink(path);
+
+    CHECK(trace_open(&trace, "/nonexistent/trace.swf") == -1);
+}
+
+/*
+ * A csv trace is picked by its extension, its header is skipped and a line
+ * too long for the buffer is dropped without losing the next one
+ */
+static void test_csv_file()
+{
+    char *contents = malloc(TRACE_LINE_LEN * 2 + 256);
+    strcpy(contents, "submit_time,runtime,priority,command\n# a comment\n0,1,2\n");
+    size_t length = strlen(contents);
+    strcpy(contents + length, "1,1,1,");
+    length += 6;
+    memset(contents + length, 'x', TRACE_LINE_LEN * 2);
+    length += TRACE_LINE_LEN * 2;
+    strcpy(contents + length, "\n2.5,0.5,3,./process\n");
+
+    char path[64];
+    write_trace(path, ".csv", contents);
+    free(contents);
+
+    trace_t trace;
+    trace_job_t job;
+    CHECK(trace_open(&trace, path) == 0);
+    CHECK(trace.csv);
+    CHECK(trace_next(&trace, &job));
+    CHECK(job.submit == 0 && job.runtime == 1 && job.priority == 2);
+    CHECK(trace_next(&trace, &job));
+    CHECK(job.submit == 2.5 && job.runtime == 0.5 && job.priority == 3);
+    CHECK(!strcmp(job.cmd, "./process"));
+    CHECK(!trace_next(&trace, &job));
+    trace_close(&trace);
+    unlink(path);
+}
+
+int main()
+{
+    test_swf_line();
+    test_csv_line();
+    test_swf_file();
+    test_csv_file();
+    return report_checks("test_trace");
+}
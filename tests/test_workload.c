@@ -0,0 +1,230 @@
+/*
+ * COMP7500/7506
+ * Project 3: workload generator tests
+ *
+ * Author: agent
+ *
+ * Date: October 17, 2026
+ *
+ * Behaviour tests for the seeded generator and the arrival, burst and
+ * priority distributions test and simulate draw from, run by make check
+ *
+ */
+
+#include "check.h"
+#include "../src/workload.c"
+
+#define DRAWS 100000
+
+/*
+ * Returns a workload with the given distributions, seeded
+ */
+static workload_t make_workload(enum arrival_dist arrival, enum burst_dist burst, enum priority_dist priority, uint64_t seed)
+{
+    workload_t workload = {0};
+    workload.arrival = arrival;
+    workload.interarrival = 0.5;
+    workload.burst = burst;
+    workload.min_burst = 0.1;
+    workload.max_burst = 10;
+    workload.burst_shape = burst == BURST_PARETO ? DEFAULT_PARETO_ALPHA : DEFAULT_LOGNORMAL_SIGMA;
+    workload.priority = priority;
+    workload.priority_levels = 8;
+    workload.zipf_s = DEFAULT_ZIPF_S;
+    workload_init(&workload, seed);
+    return workload;
+}
+
+/*
+ * The same seed replays the same jobs, another seed does not
+ */
+static void test_seed()
+{
+    workload_t a = make_workload(ARRIVAL_EXPONENTIAL, BURST_PARETO, PRIORITY_ZIPF, 42);
+    workload_t b = make_workload(ARRIVAL_EXPONENTIAL, BURST_PARETO, PRIORITY_ZIPF, 42);
+    workload_t c = make_workload(ARRIVAL_EXPONENTIAL, BURST_PARETO, PRIORITY_ZIPF, 43);
+
+    int i;
+    int same = 0;
+    for (i = 0; i < 1000; i++)
+    {
+        long long gap = workload_interarrival(&a);
+        long long burst = workload_burst(&a);
+        int priority = workload_priority(&a);
+        CHECK(gap == workload_interarrival(&b));
+        CHECK(burst == workload_burst(&b));
+        CHECK(priority == workload_priority(&b));
+        same += gap == workload_interarrival(&c);
+        workload_burst(&c);
+        workload_priority(&c);
+    }
+    CHECK(same < 10);
+
+    // seed 0 still leaves a usable state
+    workload_t zero = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, PRIORITY_UNIFORM, 0);
+    CHECK(zero.state[0] | zero.state[1] | zero.state[2] | zero.state[3]);
+
+    workload_free(&a);
+    workload_free(&b);
+    workload_free(&c);
+    workload_free(&zero);
+}
+
+/*
+ * Uniform draws stay in [0, 1) and average a half
+ */
+static void test_uniform()
+{
+    workload_t workload = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, PRIORITY_UNIFORM, 7);
+    double total = 0;
+    int in_range = 1;
+    int i;
+    for (i = 0; i < DRAWS; i++)
+    {
+        double u = workload_uniform(&workload);
+        in_range &= u >= 0 && u < 1;
+        total += u;
+    }
+    CHECK(in_range);
+    CHECK(fabs(total / DRAWS - 0.5) < 0.01);
+    workload_free(&workload);
+}
+
+/*
+ * Fixed gaps are exact, exponential gaps average the interarrival
+ */
+static void test_interarrival()
+{
+    workload_t fixed = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, PRIORITY_UNIFORM, 1);
+    CHECK(workload_interarrival(&fixed) == 500000000LL);
+    CHECK(workload_interarrival(&fixed) == 500000000LL);
+
+    workload_t poisson = make_workload(ARRIVAL_EXPONENTIAL, BURST_UNIFORM, PRIORITY_UNIFORM, 1);
+    double total = 0;
+    int positive = 1;
+    int i;
+    for (i = 0; i < DRAWS; i++)
+    {
+        long long gap = workload_interarrival(&poisson);
+        positive &= gap >= 0;
+        total += gap;
+    }
+    CHECK(positive);
+    CHECK(fabs(total / DRAWS / 1e9 - 0.5) < 0.02);
+
+    workload_free(&fixed);
+    workload_free(&poisson);
+}
+
+/*
+ * Every burst distribution stays within the bounds, pareto leans to the
+ * short end and lognormal centres on the geometric mean of the bounds
+ */
+static void test_bursts()
+{
+    enum burst_dist dists[] = {BURST_UNIFORM, BURST_PARETO, BURST_LOGNORMAL};
+    double means[3];
+    long long medians[3];
+    int d;
+    for (d = 0; d < 3; d++)
+    {
+        workload_t workload = make_workload(ARRIVAL_FIXED, dists[d], PRIORITY_UNIFORM, 11);
+        double total = 0;
+        int in_range = 1;
+        int below_one = 0;
+        int i;
+        for (i = 0; i < DRAWS; i++)
+        {
+            long long burst = workload_burst(&workload);
+            in_range &= burst >= 100000 && burst <= 10000000;
+            below_one += burst < 1000000;
+            total += burst;
+        }
+        CHECK(in_range);
+        means[d] = total / DRAWS;
+        medians[d] = below_one;
+        workload_free(&workload);
+    }
+
+    CHECK(fabs(means[0] / 1e6 - 5.05) < 0.1);
+    CHECK(means[1] < means[0]);
+    CHECK(medians[1] > DRAWS * 9 / 10); // P(X < 1) = 0.968 for alpha 1.5 on [0.1, 10]
+    CHECK(abs((int)medians[2] - DRAWS / 2) < DRAWS / 50);
+}
+
+/*
+ * Core counts cover 1..max_cpus evenly, jobs float without max_cpus
+ */
+static void test_cpus()
+{
+    workload_t workload = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, PRIORITY_UNIFORM, 3);
+    CHECK(workload_cpus(&workload) == 0);
+
+    int counts[5] = {0};
+    int in_range = 1;
+    int i;
+    workload.max_cpus = 4;
+    for (i = 0; i < DRAWS; i++)
+    {
+        int cpus = workload_cpus(&workload);
+        in_range &= cpus >= 1 && cpus <= 4;
+        if (cpus >= 1 && cpus <= 4)
+            counts[cpus]++;
+    }
+    CHECK(in_range);
+    for (i = 1; i <= 4; i++)
+    {
+        CHECK(abs(counts[i] - DRAWS / 4) < DRAWS / 50);
+    }
+    workload_free(&workload);
+}
+
+/*
+ * Priorities stay in 1..levels, uniform reaches every level and zipf
+ * weights level k by 1 / k
+ */
+static void test_priorities()
+{
+    int counts[2][9] = {{0}};
+    enum priority_dist dists[] = {PRIORITY_UNIFORM, PRIORITY_ZIPF};
+    int d;
+    for (d = 0; d < 2; d++)
+    {
+        workload_t workload = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, dists[d], 5);
+        int in_range = 1;
+        int i;
+        for (i = 0; i < DRAWS; i++)
+        {
+            int priority = workload_priority(&workload);
+            in_range &= priority >= 1 && priority <= 8;
+            if (priority >= 1 && priority <= 8)
+                counts[d][priority]++;
+        }
+        CHECK(in_range);
+        workload_free(&workload);
+    }
+
+    int level;
+    for (level = 1; level <= 8; level++)
+    {
+        CHECK(abs(counts[0][level] - DRAWS / 8) < DRAWS / 100);
+        CHECK(fabs((double)counts[1][1] / counts[1][level] - level) < 0.1 * level);
+    }
+
+    // a single level always gives 1
+    workload_t single = make_workload(ARRIVAL_FIXED, BURST_UNIFORM, PRIORITY_ZIPF, 5);
+    workload_free(&single);
+    single.priority_levels = 1;
+    CHECK(workload_priority(&single) == 1);
+}
+
+int main()
+{
+    test_seed();
+    test_uniform();
+    test_interarrival();
+    test_bursts();
+    test_priorities();
+    test_cpus();
+    return report_checks("test_workload");
+}